@@ -0,0 +1,227 @@
+#include "./hack-computer.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr uint16_t kAddressMask = 0x7fff;
+
+  constexpr uint16_t kCInstructionBit = 0x8000;
+  constexpr uint16_t kMemoryOperandBit = 0x1000;
+  constexpr int kAluShift = 6;
+  constexpr uint16_t kAluMask = 0x3f;
+  constexpr int kDestShift = 3;
+  constexpr uint16_t kDestMask = 0x7;
+  constexpr uint16_t kJumpMask = 0x7;
+
+  constexpr uint8_t kDestA = 4;
+  constexpr uint8_t kDestD = 2;
+  constexpr uint8_t kDestM = 1;
+
+  // The ALU's control bits, in instruction order.
+  constexpr uint8_t kZeroX = 0x20;
+  constexpr uint8_t kNegateX = 0x10;
+  constexpr uint8_t kZeroY = 0x08;
+  constexpr uint8_t kNegateY = 0x04;
+  constexpr uint8_t kAdd = 0x02;
+  constexpr uint8_t kNegateOut = 0x01;
+
+  // Jump bits, by the sign of the ALU output.
+  constexpr int kJumpIfNegativeShift = 2;
+  constexpr int kJumpIfZeroShift = 1;
+  constexpr int kJumpIfPositiveShift = 0;
+
+  constexpr size_t kWordLength = 16;
+}
+
+HackComputer::HackComputer() :
+  rom_(kRomSize, Decode(0)), ram_(kRamSize, 0), a_(0), d_(0), pc_(0) {}
+
+void HackComputer::LoadRom(const std::vector<uint16_t>& program) {
+  if (program.size() > kRomSize) {
+    throw std::runtime_error("Program does not fit in ROM: " +
+                             std::to_string(program.size()) + " instructions");
+  }
+  for (size_t i = 0; i < kRomSize; i++) {
+    rom_[i] = Decode(i < program.size() ? program[i] : 0);
+  }
+  a_ = 0;
+  d_ = 0;
+  pc_ = 0;
+}
+
+void HackComputer::Step(bool reset) {
+  Run(1);
+  if (reset) {
+    pc_ = 0;
+  }
+}
+
+void HackComputer::Run(uint64_t cycles) {
+  // Registers live in locals so that the compiler can keep them in
+  // machine registers across the loop.
+  const MicroOp* rom = rom_.data();
+  uint16_t* ram = ram_.data();
+  uint16_t a = a_;
+  uint16_t d = d_;
+  uint16_t pc = pc_;
+
+  for (; cycles > 0; cycles--) {
+    const MicroOp& op = rom[pc];
+    uint16_t out;
+    switch (op.op) {
+      case Op::LOAD_A:
+        a = op.value;
+        pc = (pc + 1) & kAddressMask;
+        continue;
+      case Op::ZERO: out = 0; break;
+      case Op::ONE: out = 1; break;
+      case Op::MINUS_ONE: out = 0xffff; break;
+      case Op::D: out = d; break;
+      case Op::A: out = a; break;
+      case Op::M: out = ram[a & kAddressMask]; break;
+      case Op::NOT_D: out = ~d; break;
+      case Op::NOT_A: out = ~a; break;
+      case Op::NOT_M: out = ~ram[a & kAddressMask]; break;
+      case Op::NEG_D: out = -d; break;
+      case Op::NEG_A: out = -a; break;
+      case Op::NEG_M: out = -ram[a & kAddressMask]; break;
+      case Op::D_PLUS_1: out = d + 1; break;
+      case Op::A_PLUS_1: out = a + 1; break;
+      case Op::M_PLUS_1: out = ram[a & kAddressMask] + 1; break;
+      case Op::D_MINUS_1: out = d - 1; break;
+      case Op::A_MINUS_1: out = a - 1; break;
+      case Op::M_MINUS_1: out = ram[a & kAddressMask] - 1; break;
+      case Op::D_PLUS_A: out = d + a; break;
+      case Op::D_PLUS_M: out = d + ram[a & kAddressMask]; break;
+      case Op::D_MINUS_A: out = d - a; break;
+      case Op::D_MINUS_M: out = d - ram[a & kAddressMask]; break;
+      case Op::A_MINUS_D: out = a - d; break;
+      case Op::M_MINUS_D: out = ram[a & kAddressMask] - d; break;
+      case Op::D_AND_A: out = d & a; break;
+      case Op::D_AND_M: out = d & ram[a & kAddressMask]; break;
+      case Op::D_OR_A: out = d | a; break;
+      case Op::D_OR_M: out = d | ram[a & kAddressMask]; break;
+      case Op::ALU_A: out = ComputeAlu(op.alu, d, a); break;
+      case Op::ALU_M: out = ComputeAlu(op.alu, d, ram[a & kAddressMask]); break;
+      default: out = 0; break;
+    }
+
+    // The memory write and the jump both see A as it was before this
+    // instruction, as they do in the CPU of projects/05.
+    uint16_t address = a & kAddressMask;
+    if (op.dest & kDestM) {
+      ram[address] = out;
+    }
+    if (op.dest & kDestD) {
+      d = out;
+    }
+    if (op.dest & kDestA) {
+      a = out;
+    }
+
+    bool jump = false;
+    if (op.jump != 0) {
+      int16_t value = static_cast<int16_t>(out);
+      int shift = value < 0 ? kJumpIfNegativeShift :
+                  value == 0 ? kJumpIfZeroShift : kJumpIfPositiveShift;
+      jump = (op.jump >> shift) & 1;
+    }
+    pc = jump ? address : (pc + 1) & kAddressMask;
+  }
+
+  a_ = a;
+  d_ = d;
+  pc_ = pc;
+}
+
+int16_t HackComputer::ReadRam(uint16_t address) const {
+  return static_cast<int16_t>(ram_[address & kAddressMask]);
+}
+
+void HackComputer::WriteRam(uint16_t address, int16_t value) {
+  ram_[address & kAddressMask] = static_cast<uint16_t>(value);
+}
+
+HackComputer::MicroOp HackComputer::Decode(uint16_t word) {
+  MicroOp op = { Op::LOAD_A, 0, 0, 0, 0 };
+  if ((word & kCInstructionBit) == 0) {
+    op.value = word;
+    return op;
+  }
+
+  op.alu = (word >> kAluShift) & kAluMask;
+  op.dest = (word >> kDestShift) & kDestMask;
+  op.jump = word & kJumpMask;
+  bool memory = (word & kMemoryOperandBit) != 0;
+  // The computations that the assembler has mnemonics for, by their
+  // control bits. Those that ignore the y input do not depend on `a`.
+  switch (op.alu) {
+    case 0x2a: op.op = Op::ZERO; break;
+    case 0x3f: op.op = Op::ONE; break;
+    case 0x3a: op.op = Op::MINUS_ONE; break;
+    case 0x0c: op.op = Op::D; break;
+    case 0x30: op.op = memory ? Op::M : Op::A; break;
+    case 0x0d: op.op = Op::NOT_D; break;
+    case 0x31: op.op = memory ? Op::NOT_M : Op::NOT_A; break;
+    case 0x0f: op.op = Op::NEG_D; break;
+    case 0x33: op.op = memory ? Op::NEG_M : Op::NEG_A; break;
+    case 0x1f: op.op = Op::D_PLUS_1; break;
+    case 0x37: op.op = memory ? Op::M_PLUS_1 : Op::A_PLUS_1; break;
+    case 0x0e: op.op = Op::D_MINUS_1; break;
+    case 0x32: op.op = memory ? Op::M_MINUS_1 : Op::A_MINUS_1; break;
+    case 0x02: op.op = memory ? Op::D_PLUS_M : Op::D_PLUS_A; break;
+    case 0x13: op.op = memory ? Op::D_MINUS_M : Op::D_MINUS_A; break;
+    case 0x07: op.op = memory ? Op::M_MINUS_D : Op::A_MINUS_D; break;
+    case 0x00: op.op = memory ? Op::D_AND_M : Op::D_AND_A; break;
+    case 0x15: op.op = memory ? Op::D_OR_M : Op::D_OR_A; break;
+    default: op.op = memory ? Op::ALU_M : Op::ALU_A; break;
+  }
+  return op;
+}
+
+uint16_t HackComputer::ComputeAlu(uint8_t alu, uint16_t x, uint16_t y) {
+  if (alu & kZeroX) {
+    x = 0;
+  }
+  if (alu & kNegateX) {
+    x = ~x;
+  }
+  if (alu & kZeroY) {
+    y = 0;
+  }
+  if (alu & kNegateY) {
+    y = ~y;
+  }
+  uint16_t out = (alu & kAdd) ? x + y : x & y;
+  return (alu & kNegateOut) ? ~out : out;
+}
+
+std::vector<uint16_t> ReadHackProgram(std::istream& in) {
+  std::vector<uint16_t> program;
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+    if (line.size() != kWordLength) {
+      throw std::runtime_error("Bad instruction on line " +
+                               std::to_string(line_number) + ": " + line);
+    }
+    uint16_t word = 0;
+    for (char bit : line) {
+      if (bit != '0' && bit != '1') {
+        throw std::runtime_error("Bad instruction on line " +
+                                 std::to_string(line_number) + ": " + line);
+      }
+      word = (word << 1) | (bit - '0');
+    }
+    program.push_back(word);
+  }
+  return program;
+}
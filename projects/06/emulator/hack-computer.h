@@ -0,0 +1,94 @@
+#ifndef NAND2TETRIS_PROJECTS_06_EMULATOR_HACK_COMPUTER_H
+#define NAND2TETRIS_PROJECTS_06_EMULATOR_HACK_COMPUTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+// The Hack computer of projects/05: a CPU running up to 32K words of ROM
+// against 32K words of RAM, where the screen is mapped at 16384 and the
+// keyboard at 24576.
+//
+// Each ROM word is decoded once, when the ROM is loaded, into a MicroOp
+// that names its computation outright, so running an instruction is one
+// switch and no bit twiddling. Usage:
+//
+//   HackComputer computer;
+//   computer.LoadRom(ReadHackProgram(in));
+//   computer.WriteRam(0, 3);
+//   computer.Run(1000);
+//   int16_t result = computer.ReadRam(2);
+class HackComputer {
+  public:
+    static constexpr size_t kRomSize = 32768;
+    static constexpr size_t kRamSize = 32768;
+    static constexpr uint16_t kScreenAddress = 16384;
+    static constexpr uint16_t kKeyboardAddress = 24576;
+
+    HackComputer();
+
+    // Replaces the ROM with |program|, padded with zeros, and resets the
+    // CPU. Leaves RAM as it is. Throws std::runtime_error if |program| is
+    // larger than the ROM.
+    void LoadRom(const std::vector<uint16_t>& program);
+    // Runs one clock cycle. With |reset| set, the instruction at the PC
+    // still runs but the PC goes to 0 afterwards, as with the CPU's reset
+    // pin.
+    void Step(bool reset = false);
+    // Runs |cycles| clock cycles.
+    void Run(uint64_t cycles);
+
+    int16_t GetA() const { return static_cast<int16_t>(a_); }
+    int16_t GetD() const { return static_cast<int16_t>(d_); }
+    uint16_t GetPC() const { return pc_; }
+    // Addresses wrap at the 15 bits the Hack CPU has.
+    int16_t ReadRam(uint16_t address) const;
+    void WriteRam(uint16_t address, int16_t value);
+
+  private:
+    enum class Op : uint8_t {
+      LOAD_A,
+      ZERO, ONE, MINUS_ONE,
+      D, A, M,
+      NOT_D, NOT_A, NOT_M,
+      NEG_D, NEG_A, NEG_M,
+      D_PLUS_1, A_PLUS_1, M_PLUS_1,
+      D_MINUS_1, A_MINUS_1, M_MINUS_1,
+      D_PLUS_A, D_PLUS_M,
+      D_MINUS_A, D_MINUS_M,
+      A_MINUS_D, M_MINUS_D,
+      D_AND_A, D_AND_M,
+      D_OR_A, D_OR_M,
+      // Any of the other 46 computations the ALU's six control bits can
+      // select, which the assembler has no mnemonic for.
+      ALU_A, ALU_M
+    };
+
+    struct MicroOp {
+      Op op;
+      // kDestA | kDestD | kDestM.
+      uint8_t dest;
+      // The j1 j2 j3 bits: jump if negative, zero, positive.
+      uint8_t jump;
+      // zx nx zy ny f no, for ALU_A and ALU_M.
+      uint8_t alu;
+      // The constant of a LOAD_A.
+      uint16_t value;
+    };
+
+    static MicroOp Decode(uint16_t word);
+    static uint16_t ComputeAlu(uint8_t alu, uint16_t x, uint16_t y);
+
+    std::vector<MicroOp> rom_;
+    std::vector<uint16_t> ram_;
+    uint16_t a_;
+    uint16_t d_;
+    uint16_t pc_;
+};
+
+// Reads the contents of a .hack file: one instruction per line, written as
+// 16 binary digits. Throws std::runtime_error on any other line.
+std::vector<uint16_t> ReadHackProgram(std::istream& in);
+
+#endif
@@ -0,0 +1,330 @@
+#include "./hack-translator.h"
+
+#include <iterator>
+#include <set>
+#include <string>
+
+namespace {
+  constexpr uint16_t kCInstructionBit = 0x8000;
+  constexpr uint16_t kMemoryOperandBit = 0x1000;
+  constexpr int kAluShift = 6;
+  constexpr uint16_t kAluMask = 0x3f;
+  constexpr int kDestShift = 3;
+  constexpr uint16_t kDestMask = 0x7;
+  constexpr uint16_t kJumpMask = 0x7;
+
+  constexpr uint16_t kDestA = 4;
+  constexpr uint16_t kDestD = 2;
+  constexpr uint16_t kDestM = 1;
+  constexpr uint16_t kJumpAlways = 7;
+
+  constexpr char kMemoryOperand[] = "ram[a & kAddressMask]";
+  constexpr char kAddressOperand[] = "a";
+
+  // Everything but the code for the instructions themselves.
+  constexpr char kPrologue[] = R"(// Generated by `emulator --translate`. Do not edit.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace {
+  constexpr uint16_t kAddressMask = 0x7fff;
+  constexpr size_t kRamSize = 32768;
+
+  uint16_t ram[kRamSize];
+
+  // Any computation, by the ALU's control bits.
+  uint16_t Alu(unsigned alu, uint16_t x, uint16_t y) {
+    if (alu & 0x20) {
+      x = 0;
+    }
+    if (alu & 0x10) {
+      x = ~x;
+    }
+    if (alu & 0x08) {
+      y = 0;
+    }
+    if (alu & 0x04) {
+      y = ~y;
+    }
+    uint16_t out = (alu & 0x02) ? x + y : x & y;
+    return (alu & 0x01) ? ~out : out;
+  }
+)";
+
+  constexpr char kEpilogue[] = R"(
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <cycles> [address | address=value]...\n";
+    return 1;
+  }
+  uint64_t cycles = std::stoull(argv[1]);
+  for (int i = 2; i < argc; i++) {
+    std::string argument = argv[i];
+    size_t equals = argument.find('=');
+    if (equals != std::string::npos) {
+      ram[std::stoul(argument.substr(0, equals)) & kAddressMask] =
+        static_cast<uint16_t>(std::stoi(argument.substr(equals + 1)));
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Run(cycles);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  for (int i = 2; i < argc; i++) {
+    if (std::string(argv[i]).find('=') != std::string::npos) {
+      continue;
+    }
+    uint16_t address = static_cast<uint16_t>(std::stoul(argv[i]));
+    std::cout << "RAM[" << address << "] = "
+              << static_cast<int16_t>(ram[address & kAddressMask]) << "\n";
+  }
+  std::cerr << cycles << " cycles in " << elapsed.count() << " s ("
+            << cycles / elapsed.count() / 1e6 << " million per second)\n";
+  return 0;
+}
+)";
+
+  constexpr char kStep[] = R"(
+  // Runs the instruction at |pc|.
+  void Step(uint16_t& a, uint16_t& d, uint16_t& pc) {
+    // The rest of the ROM is zeros, which is @0.
+    uint16_t word = pc < kProgramSize ? rom[pc] : 0;
+    if ((word & 0x8000) == 0) {
+      a = word;
+      pc = (pc + 1) & kAddressMask;
+      return;
+    }
+    uint16_t out = Alu((word >> 6) & 0x3f, d, (word & 0x1000) ? ram[a & kAddressMask] : a);
+    uint16_t address = a & kAddressMask;
+    if (word & 0x08) {
+      ram[address] = out;
+    }
+    if (word & 0x10) {
+      d = out;
+    }
+    if (word & 0x20) {
+      a = out;
+    }
+    int16_t value = static_cast<int16_t>(out);
+    bool jump = ((word & 0x04) && value < 0) || ((word & 0x02) && value == 0) ||
+                ((word & 0x01) && value > 0);
+    pc = jump ? address : (pc + 1) & kAddressMask;
+  }
+)";
+
+  bool IsCInstruction(uint16_t word) {
+    return (word & kCInstructionBit) != 0;
+  }
+
+  uint16_t GetJump(uint16_t word) {
+    return IsCInstruction(word) ? word & kJumpMask : 0;
+  }
+
+  // The C++ expression for the ALU output of a C-instruction.
+  std::string GetComputation(uint16_t word) {
+    std::string y = (word & kMemoryOperandBit) ? kMemoryOperand : kAddressOperand;
+    uint16_t alu = (word >> kAluShift) & kAluMask;
+    switch (alu) {
+      case 0x2a: return "0";
+      case 0x3f: return "1";
+      case 0x3a: return "0xffff";
+      case 0x0c: return "d";
+      case 0x30: return y;
+      case 0x0d: return "~d";
+      case 0x31: return "~" + y;
+      case 0x0f: return "-d";
+      case 0x33: return "-" + y;
+      case 0x1f: return "d + 1";
+      case 0x37: return y + " + 1";
+      case 0x0e: return "d - 1";
+      case 0x32: return y + " - 1";
+      case 0x02: return "d + " + y;
+      case 0x13: return "d - " + y;
+      case 0x07: return y + " - d";
+      case 0x00: return "d & " + y;
+      case 0x15: return "d | " + y;
+      default: return "Alu(" + std::to_string(alu) + ", d, " + y + ")";
+    }
+  }
+
+  // The C++ condition under which a C-instruction jumps, given its output.
+  std::string GetJumpCondition(uint16_t jump) {
+    switch (jump) {
+      case 1: return "static_cast<int16_t>(out) > 0";
+      case 2: return "out == 0";
+      case 3: return "static_cast<int16_t>(out) >= 0";
+      case 4: return "static_cast<int16_t>(out) < 0";
+      case 5: return "out != 0";
+      case 6: return "static_cast<int16_t>(out) <= 0";
+      default: return "true";
+    }
+  }
+
+  // Statements that compute a C-instruction and store its output, leaving
+  // the old A masked to an address in `address` if it jumps.
+  std::string GetCInstructionBody(uint16_t word, const std::string& indent) {
+    uint16_t dest = (word >> kDestShift) & kDestMask;
+    std::string body = indent + "out = " + GetComputation(word) + ";\n";
+    if (GetJump(word) != 0) {
+      body += indent + "address = a & kAddressMask;\n";
+    }
+    if (dest & kDestM) {
+      body += indent + "ram[a & kAddressMask] = out;\n";
+    }
+    if (dest & kDestD) {
+      body += indent + "d = out;\n";
+    }
+    if (dest & kDestA) {
+      body += indent + "a = out;\n";
+    }
+    return body;
+  }
+
+  std::string GetLabel(size_t address) {
+    return "L" + std::to_string(address);
+  }
+
+  // Addresses that start a basic block.
+  std::set<size_t> FindBlockStarts(const std::vector<uint16_t>& program) {
+    std::set<size_t> starts;
+    if (!program.empty()) {
+      starts.insert(0);
+    }
+    for (size_t i = 0; i < program.size(); i++) {
+      uint16_t word = program[i];
+      if (!IsCInstruction(word)) {
+        if (word < program.size()) {
+          starts.insert(word);
+        }
+      } else if (GetJump(word) != 0 && i + 1 < program.size()) {
+        starts.insert(i + 1);
+      }
+    }
+    return starts;
+  }
+
+  // A jump right after @target in the same block goes to a known place.
+  // Returns false for a jump that has to go through the switch.
+  bool GetStaticTarget(const std::vector<uint16_t>& program, size_t block_start,
+                       size_t jump, size_t* target) {
+    if (jump == block_start || IsCInstruction(program[jump - 1]) ||
+        program[jump - 1] >= program.size()) {
+      return false;
+    }
+    *target = program[jump - 1];
+    return true;
+  }
+
+  // The slow path decodes the program at run time from a copy kept as data,
+  // which costs far less to compile than a case per instruction.
+  void WriteStep(const std::vector<uint16_t>& program, std::ostream& out) {
+    out << "\n"
+        << "  const uint16_t rom[] = {";
+    for (size_t i = 0; i < program.size(); i++) {
+      out << (i % 12 == 0 ? "\n    " : " ") << program[i] << ",";
+    }
+    out << "\n"
+        << "    0\n"
+        << "  };\n"
+        << "  constexpr size_t kProgramSize = " << program.size() << ";\n"
+        << kStep;
+  }
+
+  void WriteRun(const std::vector<uint16_t>& program, std::ostream& out) {
+    std::set<size_t> starts = FindBlockStarts(program);
+    std::set<size_t> static_targets;
+    for (auto start = starts.begin(); start != starts.end(); start++) {
+      auto next_start = std::next(start);
+      size_t end = next_start == starts.end() ? program.size() : *next_start;
+      size_t target;
+      if (GetJump(program[end - 1]) != 0 &&
+          GetStaticTarget(program, *start, end - 1, &target)) {
+        static_targets.insert(target);
+      }
+    }
+
+    out << "\n"
+        << "  // Runs |cycles| cycles from the reset state.\n"
+        << "  void Run(uint64_t cycles) {\n"
+        << "    uint16_t a = 0;\n"
+        << "    uint16_t d = 0;\n"
+        << "    uint16_t pc = 0;\n"
+        << "    uint16_t out;\n"
+        << "    uint16_t address;\n"
+        << "  dispatch:\n"
+        << "    switch (pc) {\n";
+
+    // Blocks run on into the next one unless they end in a jump.
+    bool falls_through = false;
+    for (auto start = starts.begin(); start != starts.end(); start++) {
+      auto next_start = std::next(start);
+      size_t end = next_start == starts.end() ? program.size() : *next_start;
+      size_t length = end - *start;
+      if (falls_through) {
+        out << "        [[fallthrough]];\n";
+      }
+      falls_through = GetJump(program[end - 1]) != kJumpAlways;
+      out << "      case " << *start << ":\n";
+      if (static_targets.count(*start) != 0) {
+        out << "      " << GetLabel(*start) << ":\n";
+      }
+      out << "        if (cycles < " << length << ") {\n"
+          << "          pc = " << *start << ";\n"
+          << "          goto finish;\n"
+          << "        }\n"
+          << "        cycles -= " << length << ";\n";
+      for (size_t i = *start; i < end; i++) {
+        uint16_t word = program[i];
+        out << "        // " << i << "\n";
+        if (!IsCInstruction(word)) {
+          out << "        a = " << word << ";\n";
+          continue;
+        }
+        out << GetCInstructionBody(word, "        ");
+        uint16_t jump = GetJump(word);
+        if (jump == 0) {
+          continue;
+        }
+        size_t target;
+        std::string go_to = GetStaticTarget(program, *start, i, &target) ?
+          "goto " + GetLabel(target) + ";" :
+          "{ pc = address; goto dispatch; }";
+        if (jump == kJumpAlways) {
+          out << "        " << go_to << "\n";
+        } else {
+          out << "        if (" << GetJumpCondition(jump) << ") " << go_to << "\n";
+        }
+      }
+    }
+
+    // Past the end of the program, or into the middle of a block.
+    out << "        pc = " << (program.size() & 0x7fff) << ";\n"
+        << "        goto dispatch;\n"
+        << "      default:\n"
+        << "        if (cycles == 0) {\n"
+        << "          return;\n"
+        << "        }\n"
+        << "        Step(a, d, pc);\n"
+        << "        cycles--;\n"
+        << "        goto dispatch;\n"
+        << "    }\n"
+        << "  finish:\n"
+        << "    for (; cycles > 0; cycles--) {\n"
+        << "      Step(a, d, pc);\n"
+        << "    }\n"
+        << "    (void)address;\n"
+        << "  }\n"
+        << "}\n";
+  }
+}
+
+void TranslateHackProgram(const std::vector<uint16_t>& program, std::ostream& out) {
+  out << kPrologue;
+  WriteStep(program, out);
+  WriteRun(program, out);
+  out << kEpilogue;
+}
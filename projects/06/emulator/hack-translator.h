@@ -0,0 +1,27 @@
+#ifndef NAND2TETRIS_PROJECTS_06_EMULATOR_HACK_TRANSLATOR_H
+#define NAND2TETRIS_PROJECTS_06_EMULATOR_HACK_TRANSLATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Translates a Hack program into a C++ program that runs it natively, with
+// the same results as HackComputer cycle for cycle. The output has a main
+// taking the same arguments as `emulator <program.hack>`: a cycle count,
+// then RAM addresses to print and address=value pairs to set first.
+//
+// Each instruction that can start a basic block becomes a case of one big
+// switch on the PC, and the instructions up to the next such one run as
+// straight-line code. A jump right after `@target` goes to the target's
+// case label directly; any other jump, such as a return through an address
+// in RAM, goes back through the switch. Blocks start at 0, after jumps, at
+// jump targets, and at any address an A-instruction loads, since that may
+// be jumped to later; a jump anywhere else takes a slower path that runs
+// one instruction at a time until it reaches the start of a block.
+//
+// Whole blocks are charged against the cycle count on entry. Once a block
+// no longer fits in the cycles left, the rest run one at a time, so a run
+// stops after exactly as many cycles as asked.
+void TranslateHackProgram(const std::vector<uint16_t>& program, std::ostream& out);
+
+#endif
@@ -0,0 +1,102 @@
+#include "./hack-computer.h"
+#include "./hack-translator.h"
+#include "./test-script.h"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr char kTestScriptExtension[] = ".tst";
+  constexpr char kTranslateFlag[] = "--translate";
+
+  void PrintUsage() {
+    std::cerr << "Usage: emulator <script.tst>\n"
+              << "       emulator <program.hack> <cycles> [address | address=value]...\n"
+              << "       emulator --translate <program.hack> <output.cpp>\n";
+  }
+
+  int TranslateProgram(const std::string& file_in, const std::string& file_out) {
+    std::ifstream in(file_in);
+    if (!in) {
+      std::cerr << "Cannot read " << file_in << "\n";
+      return 1;
+    }
+    std::vector<uint16_t> program = ReadHackProgram(in);
+    std::ofstream out(file_out);
+    TranslateHackProgram(program, out);
+    if (!out) {
+      std::cerr << "Cannot write " << file_out << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  // Sets the RAM words given as address=value, runs the program for the
+  // given number of cycles, then prints the RAM words given as address,
+  // and the speed on stderr.
+  int RunProgram(int argc, char** argv) {
+    std::ifstream in(argv[1]);
+    if (!in) {
+      std::cerr << "Cannot read " << argv[1] << "\n";
+      return 1;
+    }
+    HackComputer computer;
+    computer.LoadRom(ReadHackProgram(in));
+    uint64_t cycles = std::stoull(argv[2]);
+    for (int i = 3; i < argc; i++) {
+      std::string argument = argv[i];
+      size_t equals = argument.find('=');
+      if (equals != std::string::npos) {
+        computer.WriteRam(static_cast<uint16_t>(std::stoul(argument.substr(0, equals))),
+                          static_cast<int16_t>(std::stoi(argument.substr(equals + 1))));
+      }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    computer.Run(cycles);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (int i = 3; i < argc; i++) {
+      if (std::string(argv[i]).find('=') != std::string::npos) {
+        continue;
+      }
+      uint16_t address = static_cast<uint16_t>(std::stoul(argv[i]));
+      std::cout << "RAM[" << address << "] = " << computer.ReadRam(address) << "\n";
+    }
+    std::cerr << cycles << " cycles in " << elapsed.count() << " s ("
+              << cycles / elapsed.count() / 1e6 << " million per second)\n";
+    return 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    PrintUsage();
+    return 1;
+  }
+  try {
+    if (argv[1] == std::string(kTranslateFlag)) {
+      if (argc != 4) {
+        PrintUsage();
+        return 1;
+      }
+      return TranslateProgram(argv[2], argv[3]);
+    }
+    if (boost::filesystem::path(argv[1]).extension() == kTestScriptExtension) {
+      return RunTestScript(argv[1], std::cout) ? 0 : 1;
+    }
+    if (argc < 3) {
+      PrintUsage();
+      return 1;
+    }
+    return RunProgram(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,367 @@
+#include "./test-script.h"
+
+#include "./hack-computer.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+  constexpr char kComputerChip[] = "Computer.hdl";
+  constexpr char kRomName[] = "ROM32K";
+  constexpr char kRamName[] = "RAM16K";
+  constexpr char kARegisterName[] = "ARegister";
+  constexpr char kDRegisterName[] = "DRegister";
+  constexpr char kPCName[] = "PC";
+  constexpr char kResetName[] = "reset";
+  constexpr char kTimeName[] = "time";
+  constexpr char kHalfCycleSuffix = '+';
+  constexpr char kColumnSeparator = '|';
+  constexpr char kFormatStart = '%';
+  constexpr char kPunctuation[] = ",;{}";
+
+  struct Command {
+    // Empty for `repeat n { body }`.
+    std::vector<std::string> words;
+    int repeat_count = 0;
+    std::vector<Command> body;
+  };
+
+  struct Column {
+    std::string variable;
+    // 'B', 'D', 'S' or 'X'.
+    char format;
+    size_t left;
+    size_t width;
+    size_t right;
+  };
+
+  // Splits a script into words, string literals (quotes included) and the
+  // punctuation characters, dropping comments.
+  std::vector<std::string> Tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < text.size()) {
+      char c = text[i];
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        i++;
+      } else if (text.compare(i, 2, "//") == 0) {
+        i = text.find('\n', i);
+      } else if (text.compare(i, 2, "/*") == 0) {
+        size_t end = text.find("*/", i + 2);
+        i = end == std::string::npos ? end : end + 2;
+      } else if (c == '"') {
+        size_t end = text.find('"', i + 1);
+        if (end == std::string::npos) {
+          throw std::runtime_error("Unterminated string in test script");
+        }
+        tokens.push_back(text.substr(i, end + 1 - i));
+        i = end + 1;
+      } else if (std::string(kPunctuation).find(c) != std::string::npos) {
+        tokens.push_back(std::string(1, c));
+        i++;
+      } else {
+        size_t start = i;
+        while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) &&
+               std::string(kPunctuation).find(text[i]) == std::string::npos) {
+          i++;
+        }
+        tokens.push_back(text.substr(start, i - start));
+      }
+    }
+    return tokens;
+  }
+
+  // Parses commands up to the end of the script, or up to the `}` that
+  // closes a repeat when |nested|.
+  std::vector<Command> ParseCommands(const std::vector<std::string>& tokens, size_t* next,
+                                     bool nested) {
+    std::vector<Command> commands;
+    while (*next < tokens.size()) {
+      const std::string& token = tokens[*next];
+      if (token == "}") {
+        if (!nested) {
+          throw std::runtime_error("Unexpected } in test script");
+        }
+        (*next)++;
+        return commands;
+      }
+      Command command;
+      if (token == "repeat") {
+        if (*next + 2 >= tokens.size() || tokens[*next + 2] != "{") {
+          throw std::runtime_error("Expected repeat <count> { in test script");
+        }
+        command.repeat_count = std::stoi(tokens[*next + 1]);
+        *next += 3;
+        command.body = ParseCommands(tokens, next, /*nested=*/true);
+        commands.push_back(command);
+        continue;
+      }
+      while (*next < tokens.size() && tokens[*next] != "," && tokens[*next] != ";") {
+        if (tokens[*next] == "{" || tokens[*next] == "}") {
+          throw std::runtime_error("Unexpected " + tokens[*next] + " in test script");
+        }
+        command.words.push_back(tokens[(*next)++]);
+      }
+      if (*next == tokens.size()) {
+        throw std::runtime_error("Missing , or ; after the last command of the test script");
+      }
+      (*next)++;
+      if (!command.words.empty()) {
+        commands.push_back(command);
+      }
+    }
+    if (nested) {
+      throw std::runtime_error("Missing } in test script");
+    }
+    return commands;
+  }
+
+  // time%S1.4.1 -> { "time", 'S', 1, 4, 1 }.
+  Column ParseColumn(const std::string& spec) {
+    size_t format = spec.find(kFormatStart);
+    Column column;
+    if (format == std::string::npos || format + 2 >= spec.size()) {
+      throw std::runtime_error("Bad output-list entry: " + spec);
+    }
+    column.variable = spec.substr(0, format);
+    column.format = spec[format + 1];
+    char dot;
+    std::istringstream padding(spec.substr(format + 2));
+    if (!(padding >> column.left >> dot >> column.width >> dot >> column.right) ||
+        std::string("BDSX").find(column.format) == std::string::npos) {
+      throw std::runtime_error("Bad output-list entry: " + spec);
+    }
+    return column;
+  }
+
+  // Values may be written as in the simulator: 42, %D42, %B101010, %X2A.
+  int16_t ParseValue(const std::string& text) {
+    int base = 10;
+    std::string digits = text;
+    if (text.size() > 2 && text[0] == kFormatStart) {
+      base = text[1] == 'B' ? 2 : text[1] == 'X' ? 16 : 10;
+      digits = text.substr(2);
+    }
+    size_t end;
+    long value = std::stol(digits, &end, base);
+    if (end != digits.size()) {
+      throw std::runtime_error("Bad value in test script: " + text);
+    }
+    return static_cast<int16_t>(value);
+  }
+
+  // "ARegister[0]", "ARegister[]" and "ARegister" all have the name
+  // "ARegister".
+  bool HasName(const std::string& variable, const std::string& name) {
+    return variable.compare(0, name.size(), name) == 0 &&
+           (variable.size() == name.size() || variable[name.size()] == '[');
+  }
+
+  // "RAM16K[5]" -> 5.
+  uint16_t GetIndex(const std::string& variable) {
+    size_t open = variable.find('[');
+    if (open == std::string::npos || variable.back() != ']' || open + 2 >= variable.size()) {
+      throw std::runtime_error("Missing address in " + variable);
+    }
+    return static_cast<uint16_t>(std::stoi(variable.substr(open + 1)));
+  }
+
+  class TestScriptRunner {
+    public:
+      TestScriptRunner(const boost::filesystem::path& directory, std::ostream& log) :
+        directory_(directory), log_(log), reset_(false), time_(0), half_cycle_(false),
+        output_lines_(0), failed_(false) {}
+
+      // Returns false once an output line does not match.
+      bool Execute(const std::vector<Command>& commands) {
+        for (const Command& command : commands) {
+          if (command.words.empty()) {
+            for (int i = 0; i < command.repeat_count && !failed_; i++) {
+              Execute(command.body);
+            }
+          } else {
+            ExecuteCommand(command.words);
+          }
+          if (failed_) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    private:
+      void ExecuteCommand(const std::vector<std::string>& words) {
+        const std::string& name = words[0];
+        if (name == "load" && words.size() == 2) {
+          if (words[1] != kComputerChip) {
+            throw std::runtime_error("Only " + std::string(kComputerChip) + " can be loaded");
+          }
+        } else if (name == "output-file" && words.size() == 2) {
+          out_.open((directory_ / words[1]).string());
+          if (!out_) {
+            throw std::runtime_error("Cannot write " + words[1]);
+          }
+        } else if (name == "compare-to" && words.size() == 2) {
+          std::ifstream in((directory_ / words[1]).string());
+          if (!in) {
+            throw std::runtime_error("Cannot read " + words[1]);
+          }
+          std::string line;
+          while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') {
+              line.pop_back();
+            }
+            compare_lines_.push_back(line);
+          }
+        } else if (name == "output-list") {
+          columns_.clear();
+          for (size_t i = 1; i < words.size(); i++) {
+            columns_.push_back(ParseColumn(words[i]));
+          }
+          WriteLine(FormatHeader());
+        } else if (name == kRomName && words.size() == 3 && words[1] == "load") {
+          std::ifstream in((directory_ / words[2]).string());
+          if (!in) {
+            throw std::runtime_error("Cannot read " + words[2]);
+          }
+          computer_.LoadRom(ReadHackProgram(in));
+        } else if (name == "set" && words.size() == 3) {
+          Set(words[1], ParseValue(words[2]));
+        } else if (name == "tick" && words.size() == 1) {
+          half_cycle_ = true;
+        } else if (name == "tock" && words.size() == 1) {
+          computer_.Step(reset_);
+          half_cycle_ = false;
+          time_++;
+        } else if (name == "output" && words.size() == 1) {
+          WriteLine(FormatValues());
+        } else if (name == "echo" && words.size() == 2) {
+          log_ << words[1].substr(1, words[1].size() - 2) << "\n";
+        } else {
+          throw std::runtime_error("Unsupported test script command: " + name);
+        }
+      }
+
+      void Set(const std::string& variable, int16_t value) {
+        if (variable == kResetName) {
+          reset_ = value != 0;
+        } else if (HasName(variable, kRamName)) {
+          computer_.WriteRam(GetIndex(variable), value);
+        } else {
+          throw std::runtime_error("Cannot set " + variable);
+        }
+      }
+
+      std::string GetValue(const Column& column) const {
+        const std::string& variable = column.variable;
+        if (variable == kTimeName) {
+          std::string time = std::to_string(time_);
+          return half_cycle_ ? time + kHalfCycleSuffix : time;
+        }
+        int16_t value;
+        if (variable == kResetName) {
+          value = reset_ ? 1 : 0;
+        } else if (HasName(variable, kARegisterName)) {
+          value = computer_.GetA();
+        } else if (HasName(variable, kDRegisterName)) {
+          value = computer_.GetD();
+        } else if (HasName(variable, kPCName)) {
+          value = static_cast<int16_t>(computer_.GetPC());
+        } else if (HasName(variable, kRamName)) {
+          value = computer_.ReadRam(GetIndex(variable));
+        } else {
+          throw std::runtime_error("Unknown variable " + variable);
+        }
+
+        if (column.format == 'D' || column.format == 'S') {
+          return std::to_string(value);
+        }
+        // Binary and hexadecimal show the low bits that fit the width.
+        int bits_per_digit = column.format == 'B' ? 1 : 4;
+        std::string digits(column.width, '0');
+        uint16_t bits = static_cast<uint16_t>(value);
+        for (size_t i = column.width; i > 0 && bits != 0; i--) {
+          digits[i - 1] = "0123456789ABCDEF"[bits & ((1 << bits_per_digit) - 1)];
+          bits >>= bits_per_digit;
+        }
+        return digits;
+      }
+
+      std::string FormatHeader() const {
+        std::string line(1, kColumnSeparator);
+        for (const Column& column : columns_) {
+          size_t size = column.left + column.width + column.right;
+          std::string name = column.variable.substr(0, size);
+          size_t left = (size - name.size()) / 2;
+          line += std::string(left, ' ') + name + std::string(size - left - name.size(), ' ');
+          line += kColumnSeparator;
+        }
+        return line;
+      }
+
+      std::string FormatValues() const {
+        std::string line(1, kColumnSeparator);
+        for (const Column& column : columns_) {
+          std::string value = GetValue(column);
+          std::string padding(value.size() < column.width ? column.width - value.size() : 0, ' ');
+          line += std::string(column.left, ' ');
+          // Strings are left-aligned, numbers right-aligned.
+          line += column.format == 'S' ? value + padding : padding + value;
+          line += std::string(column.right, ' ');
+          line += kColumnSeparator;
+        }
+        return line;
+      }
+
+      void WriteLine(const std::string& line) {
+        if (out_.is_open()) {
+          out_ << line << "\n";
+        }
+        output_lines_++;
+        if (output_lines_ <= compare_lines_.size() &&
+            compare_lines_[output_lines_ - 1] != line) {
+          log_ << "Comparison failure at line " << output_lines_ << "\n"
+               << "expected: " << compare_lines_[output_lines_ - 1] << "\n"
+               << "actual:   " << line << "\n";
+          failed_ = true;
+        }
+      }
+
+      boost::filesystem::path directory_;
+      std::ostream& log_;
+      HackComputer computer_;
+      bool reset_;
+      int time_;
+      bool half_cycle_;
+      std::vector<Column> columns_;
+      std::ofstream out_;
+      std::vector<std::string> compare_lines_;
+      size_t output_lines_;
+      bool failed_;
+  };
+}
+
+bool RunTestScript(const std::string& path, std::ostream& log) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Cannot read " + path);
+  }
+  std::stringstream contents;
+  contents << in.rdbuf();
+
+  std::vector<std::string> tokens = Tokenize(contents.str());
+  size_t next = 0;
+  std::vector<Command> commands = ParseCommands(tokens, &next, /*nested=*/false);
+
+  TestScriptRunner runner(boost::filesystem::path(path).parent_path(), log);
+  if (!runner.Execute(commands)) {
+    return false;
+  }
+  log << "End of script - Comparison ended successfully\n";
+  return true;
+}
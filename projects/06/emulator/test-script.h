@@ -0,0 +1,22 @@
+#ifndef NAND2TETRIS_PROJECTS_06_EMULATOR_TEST_SCRIPT_H
+#define NAND2TETRIS_PROJECTS_06_EMULATOR_TEST_SCRIPT_H
+
+#include <ostream>
+#include <string>
+
+// Runs a hardware simulator test script for the Computer chip, such as
+// projects/05/ComputerAdd.tst, on a HackComputer instead of the chip.
+//
+// Scripts may use the commands those tests use: load, output-file,
+// compare-to, output-list, ROM32K load, set, tick, tock, output, echo and
+// repeat n { ... }. Variables are time, reset, ARegister[], DRegister[],
+// PC[] and RAM16K[address]. Output is written to the output file the way
+// the simulator writes it, and then compared with the compare-to file
+// line by line.
+//
+// Returns false, after describing the first differing line on |log|, if
+// the comparison fails. Throws std::runtime_error on scripts it cannot
+// run.
+bool RunTestScript(const std::string& path, std::ostream& log);
+
+#endif
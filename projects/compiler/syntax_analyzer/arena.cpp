@@ -0,0 +1,28 @@
+#include "./arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+  constexpr size_t kBlockSize = 64 * 1024;
+
+  // Bytes needed to round |pointer| up to a multiple of |alignment|.
+  size_t GetPadding(const char* pointer, size_t alignment) {
+    return -reinterpret_cast<uintptr_t>(pointer) & (alignment - 1);
+  }
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  size_t padding = GetPadding(position_, alignment);
+  if (padding + size > static_cast<size_t>(end_ - position_)) {
+    size_t block_size = std::max(kBlockSize, size + alignment);
+    blocks_.emplace_back(new char[block_size]);
+    position_ = blocks_.back().get();
+    end_ = position_ + block_size;
+    padding = GetPadding(position_, alignment);
+  }
+  char* memory = position_ + padding;
+  position_ = memory + size;
+  bytes_allocated_ += size;
+  return memory;
+}
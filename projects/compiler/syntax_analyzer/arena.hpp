@@ -0,0 +1,75 @@
+#ifndef SYNTAX_ANALYZER_ARENA_HPP_
+#define SYNTAX_ANALYZER_ARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A fixed-size array allocated in an Arena. It does not own its elements.
+template <typename T>
+class ArenaArray {
+ public:
+  ArenaArray() : data_(nullptr), size_(0) {}
+  ArenaArray(T* data, size_t size) : data_(data), size_(size) {}
+
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  T& operator[](size_t index) const { return data_[index]; }
+
+ private:
+  T* data_;
+  size_t size_;
+};
+
+// A bump-pointer allocator. Objects are carved out of large blocks and are
+// never freed one by one; all of them are released together when the arena
+// is destroyed. Destructors are not run, so only trivially destructible
+// types may be allocated.
+class Arena {
+ public:
+  Arena() : position_(nullptr), end_(nullptr), bytes_allocated_(0) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of
+  // two.
+  void* Allocate(size_t size, size_t alignment);
+
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena objects are never destroyed");
+    void* memory = Allocate(sizeof(T), alignof(T));
+    return new (memory) T(std::forward<Args>(args)...);
+  }
+
+  // Copies |elements| into the arena.
+  template <typename T>
+  ArenaArray<T> NewArray(const std::vector<T>& elements) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Arena arrays are copied bytewise");
+    if (elements.empty()) {
+      return ArenaArray<T>();
+    }
+    T* data = static_cast<T*>(Allocate(sizeof(T) * elements.size(), alignof(T)));
+    std::uninitialized_copy(elements.begin(), elements.end(), data);
+    return ArenaArray<T>(data, elements.size());
+  }
+
+  // Total bytes handed out so far, excluding alignment padding.
+  size_t GetBytesAllocated() const { return bytes_allocated_; }
+
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* position_;
+  char* end_;
+  size_t bytes_allocated_;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef SYNTAX_ANALYZER_AST_HPP_
+#define SYNTAX_ANALYZER_AST_HPP_
+
+#include <string_view>
+
+#include "./arena.hpp"
+#include "./token.hpp"
+
+// Typed syntax tree of one Jack class, as built by CompilationEngine.
+//
+// Nodes live in the engine's Arena and are released with it. Names,
+// keywords and constants are kept as the Tokens they were parsed from, so
+// they still point into the engine's source buffer and carry their line
+// and column. Each node has a |type| tag; fields that do not apply to a
+// node's type are left null or empty.
+
+struct ExpressionNode;
+struct StatementNode;
+
+// subroutineName '(' expressionList ')' |
+// (className | varName) '.' subroutineName '(' expressionList ')'
+struct SubroutineCallNode {
+  bool has_receiver = false;
+  // The className or varName before the '.'.
+  Token receiver;
+  Token name;
+  ArenaArray<ExpressionNode*> arguments;
+};
+
+struct TermNode {
+  enum class TermType {
+    INT_CONSTANT,
+    STRING_CONSTANT,
+    KEYWORD_CONSTANT,
+    VARIABLE,
+    ARRAY_ELEMENT,
+    SUBROUTINE_CALL,
+    PARENTHESIZED,
+    UNARY_OP
+  };
+
+  explicit TermNode(TermType type) : type(type) {}
+
+  TermType type;
+  // The constant, the variable name or the unary operator symbol.
+  Token token;
+  // The index of an ARRAY_ELEMENT, or the body of a PARENTHESIZED term.
+  ExpressionNode* expression = nullptr;
+  // The operand of a UNARY_OP.
+  TermNode* operand = nullptr;
+  SubroutineCallNode* call = nullptr;
+};
+
+// One "op term" step of an expression.
+struct OperationNode {
+  Token op;
+  TermNode* term;
+};
+
+// term (op term)*. Jack has no operator precedence, so operations are
+// applied left to right in the order they appear.
+struct ExpressionNode {
+  TermNode* first = nullptr;
+  ArenaArray<OperationNode> operations;
+};
+
+struct StatementNode {
+  enum class StatementType {
+    LET,
+    IF,
+    WHILE,
+    DO,
+    RETURN
+  };
+
+  explicit StatementNode(StatementType type) : type(type) {}
+
+  StatementType type;
+  // The let, if, while, do or return keyword.
+  Token keyword;
+  // LET: the assigned variable, and the array index if it has one.
+  Token var_name;
+  ExpressionNode* index = nullptr;
+  // LET: the assigned value. IF, WHILE: the condition. RETURN: the
+  // returned value, or null for a bare `return;`.
+  ExpressionNode* expression = nullptr;
+  // IF: the then-branch. WHILE: the loop body.
+  ArenaArray<StatementNode*> statements;
+  // IF: the else-branch, if present.
+  bool has_else = false;
+  ArenaArray<StatementNode*> else_statements;
+  // DO: the called subroutine.
+  SubroutineCallNode* call = nullptr;
+};
+
+// A `static`, `field` or `var` declaration of one or more variables.
+struct VarDecNode {
+  Token keyword;
+  // An int, char or boolean keyword, or a class name.
+  Token type;
+  ArenaArray<Token> names;
+};
+
+struct ParameterNode {
+  Token type;
+  Token name;
+};
+
+struct SubroutineBodyNode {
+  // The body's source text, from its opening to its closing brace.
+  std::string_view source;
+  ArenaArray<VarDecNode*> var_decs;
+  ArenaArray<StatementNode*> statements;
+};
+
+struct SubroutineDecNode {
+  // The constructor, function or method keyword.
+  Token keyword;
+  // The void keyword, or a type as in VarDecNode.
+  Token return_type;
+  Token name;
+  ArenaArray<ParameterNode> parameters;
+  SubroutineBodyNode* body = nullptr;
+};
+
+struct ClassNode {
+  Token name;
+  ArenaArray<VarDecNode*> var_decs;
+  ArenaArray<SubroutineDecNode*> subroutines;
+};
+
+#endif
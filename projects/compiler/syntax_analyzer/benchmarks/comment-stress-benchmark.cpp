@@ -0,0 +1,82 @@
+// Stress benchmark for comment and string-constant scanning in Tokenizer.
+//
+// Writes a Jack class whose body is dominated by a block comment, a run of
+// line comments and a run of string constants, each |size| bytes long, then
+// times how long the tokenizer takes to get through it.
+//
+// Build and run from projects/compiler/syntax_analyzer:
+//   g++ -std=c++17 -O2 -o comment-stress benchmarks/comment-stress-benchmark.cpp tokenizer.cpp source-buffer.cpp token.cpp
+//   ./comment-stress [size_in_megabytes]
+
+#include "../tokenizer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+  constexpr char kBenchmarkFile[] = "comment-stress-benchmark.jack";
+  constexpr size_t kBytesPerMegabyte = 1 << 20;
+  constexpr size_t kDefaultMegabytes = 8;
+  constexpr size_t kLineCommentWidth = 80;
+  const std::string kDocCommentLine =
+    " * Returns x/y rounded towards zero, as in Math.divide; see Math.jack.\n";
+  constexpr size_t kStringConstantLength = 16384;
+  // "class Main { function void main ( ) { ... } }" plus
+  // "do Output . printString ( <string> ) ;" per string constant.
+  constexpr size_t kClassTokens = 11;
+  constexpr size_t kTokensPerString = 8;
+
+  size_t GetNumStrings(size_t size) {
+    return (size + kStringConstantLength - 1) / kStringConstantLength;
+  }
+
+  void WriteBenchmarkSource(const std::string& filename, size_t size) {
+    std::ofstream out(filename);
+    // A documentation comment: one '*' per line, plus the odd '/' that is
+    // not preceded by a '*'.
+    out << "/**\n";
+    for (size_t i = 0; i < size; i += kDocCommentLine.size()) {
+      out << kDocCommentLine;
+    }
+    out << " */\n";
+    for (size_t i = 0; i < size; i += kLineCommentWidth) {
+      out << "//" << std::string(kLineCommentWidth - 3, '/') << "\n";
+    }
+    out << "class Main { function void main() {\n";
+    for (size_t i = 0; i < GetNumStrings(size); i++) {
+      out << "do Output.printString(\"" << std::string(kStringConstantLength, 'x')
+          << "\");\n";
+    }
+    out << "} }\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t megabytes = argc > 1 ? std::atoi(argv[1]) : kDefaultMegabytes;
+  size_t size = megabytes * kBytesPerMegabyte;
+  WriteBenchmarkSource(kBenchmarkFile, size);
+
+  auto start = std::chrono::steady_clock::now();
+  Tokenizer tokenizer(kBenchmarkFile);
+  size_t tokens = 0;
+  while (tokenizer.HasNextToken()) {
+    tokens++;
+    tokenizer.Advance();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::remove(kBenchmarkFile);
+
+  size_t expected_tokens = kClassTokens + kTokensPerString * GetNumStrings(size);
+  if (tokens != expected_tokens) {
+    std::cerr << "Expected " << expected_tokens << " tokens, got " << tokens << "\n";
+    return 1;
+  }
+  double total_megabytes = 3.0 * megabytes;
+  std::cout << "Tokenized " << total_megabytes << " MB in " << elapsed.count() << " s ("
+            << total_megabytes / elapsed.count() << " MB/s)\n";
+  return 0;
+}
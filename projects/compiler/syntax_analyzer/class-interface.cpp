@@ -0,0 +1,224 @@
+#include "./class-interface.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+  constexpr char kInterfaceMagic[] = { 'J', 'C', 'I', '1' };
+  constexpr size_t kInterfaceMagicSize = sizeof(kInterfaceMagic);
+  constexpr char kInterfaceExtension[] = ".jci";
+
+  constexpr Token::Keyword kConstructor = Token::Keyword::CONSTRUCTOR;
+  constexpr Token::Keyword kFunction = Token::Keyword::FUNCTION;
+  constexpr Token::Keyword kMethod = Token::Keyword::METHOD;
+
+  struct OSSubroutine {
+    const char* class_name;
+    const char* name;
+    Token::Keyword kind;
+    int num_parameters;
+  };
+
+  // The subroutines declared by the OS classes in projects/12, whose
+  // implementations ship as VM code and so are never compiled along with
+  // a program.
+  constexpr OSSubroutine kOSSubroutines[] = {
+    { "Array", "new", kFunction, 1 },
+    { "Array", "dispose", kMethod, 0 },
+    { "Keyboard", "init", kFunction, 0 },
+    { "Keyboard", "keyPressed", kFunction, 0 },
+    { "Keyboard", "readChar", kFunction, 0 },
+    { "Keyboard", "readLine", kFunction, 1 },
+    { "Keyboard", "readInt", kFunction, 1 },
+    { "Math", "init", kFunction, 0 },
+    { "Math", "abs", kFunction, 1 },
+    { "Math", "multiply", kFunction, 2 },
+    { "Math", "divide", kFunction, 2 },
+    { "Math", "sqrt", kFunction, 1 },
+    { "Math", "max", kFunction, 2 },
+    { "Math", "min", kFunction, 2 },
+    { "Memory", "init", kFunction, 0 },
+    { "Memory", "peek", kFunction, 1 },
+    { "Memory", "poke", kFunction, 2 },
+    { "Memory", "alloc", kFunction, 1 },
+    { "Memory", "deAlloc", kFunction, 1 },
+    { "Output", "init", kFunction, 0 },
+    { "Output", "initMap", kFunction, 0 },
+    { "Output", "create", kFunction, 12 },
+    { "Output", "getMap", kFunction, 1 },
+    { "Output", "moveCursor", kFunction, 2 },
+    { "Output", "printChar", kFunction, 1 },
+    { "Output", "printString", kFunction, 1 },
+    { "Output", "printInt", kFunction, 1 },
+    { "Output", "println", kFunction, 0 },
+    { "Output", "backSpace", kFunction, 0 },
+    { "Screen", "init", kFunction, 0 },
+    { "Screen", "clearScreen", kFunction, 0 },
+    { "Screen", "setColor", kFunction, 1 },
+    { "Screen", "drawPixel", kFunction, 2 },
+    { "Screen", "drawLine", kFunction, 4 },
+    { "Screen", "drawRectangle", kFunction, 4 },
+    { "Screen", "drawCircle", kFunction, 3 },
+    { "String", "new", kConstructor, 1 },
+    { "String", "dispose", kMethod, 0 },
+    { "String", "length", kMethod, 0 },
+    { "String", "charAt", kMethod, 1 },
+    { "String", "setCharAt", kMethod, 2 },
+    { "String", "appendChar", kMethod, 1 },
+    { "String", "eraseLastChar", kMethod, 0 },
+    { "String", "intValue", kMethod, 0 },
+    { "String", "setInt", kMethod, 1 },
+    { "String", "newLine", kFunction, 0 },
+    { "String", "backSpace", kFunction, 0 },
+    { "String", "doubleQuote", kFunction, 0 },
+    { "Sys", "init", kFunction, 0 },
+    { "Sys", "halt", kFunction, 0 },
+    { "Sys", "wait", kFunction, 1 },
+    { "Sys", "error", kFunction, 1 },
+  };
+
+  void WriteUInt16(std::ostream& out, size_t value) {
+    if (value > UINT16_MAX) {
+      throw std::runtime_error("Class interface too large!");
+    }
+    out.put(static_cast<char>(value & 0xff));
+    out.put(static_cast<char>(value >> 8));
+  }
+
+  void WriteName(std::ostream& out, std::string_view name) {
+    WriteUInt16(out, name.size());
+    out.write(name.data(), name.size());
+  }
+
+  uint16_t ReadUInt16(std::istream& in) {
+    unsigned char bytes[2];
+    if (!in.read(reinterpret_cast<char*>(bytes), 2)) {
+      throw std::runtime_error("Truncated class interface!");
+    }
+    return bytes[0] | (bytes[1] << 8);
+  }
+
+  std::string ReadName(std::istream& in) {
+    std::string name(ReadUInt16(in), '\0');
+    if (!in.read(&name[0], name.size())) {
+      throw std::runtime_error("Truncated class interface!");
+    }
+    return name;
+  }
+}
+
+bool ClassInterface::Subroutine::operator==(const Subroutine& other) const {
+  return name == other.name && kind == other.kind &&
+         num_parameters == other.num_parameters;
+}
+
+ClassInterface ClassInterface::FromClass(const ClassNode& node) {
+  ClassInterface interface;
+  interface.name = node.name.GetIdentifier();
+  for (const VarDecNode* var_dec : node.var_decs) {
+    if (var_dec->keyword.GetKeyword() == Token::Keyword::FIELD) {
+      interface.num_fields += var_dec->names.size();
+    }
+  }
+  for (const SubroutineDecNode* subroutine : node.subroutines) {
+    interface.subroutines.push_back({ std::string(subroutine->name.GetIdentifier()),
+                                      subroutine->keyword.GetKeyword(),
+                                      static_cast<int>(subroutine->parameters.size()) });
+  }
+  return interface;
+}
+
+const ClassInterface::Subroutine* ClassInterface::FindSubroutine(std::string_view name) const {
+  // Classes have a handful of subroutines; a scan beats building an index.
+  for (const Subroutine& subroutine : subroutines) {
+    if (subroutine.name == name) {
+      return &subroutine;
+    }
+  }
+  return nullptr;
+}
+
+bool ClassInterface::operator==(const ClassInterface& other) const {
+  return name == other.name && num_fields == other.num_fields &&
+         subroutines == other.subroutines;
+}
+
+void WriteClassInterface(const ClassInterface& interface, std::ostream& out) {
+  out.write(kInterfaceMagic, kInterfaceMagicSize);
+  WriteName(out, interface.name);
+  WriteUInt16(out, interface.num_fields);
+  WriteUInt16(out, interface.subroutines.size());
+  for (const auto& subroutine : interface.subroutines) {
+    out.put(static_cast<char>(subroutine.kind));
+    WriteUInt16(out, subroutine.num_parameters);
+    WriteName(out, subroutine.name);
+  }
+}
+
+ClassInterface ReadClassInterface(std::istream& in) {
+  char magic[kInterfaceMagicSize];
+  if (!in.read(magic, kInterfaceMagicSize) ||
+      !std::equal(magic, magic + kInterfaceMagicSize, kInterfaceMagic)) {
+    throw std::runtime_error("Not a class interface!");
+  }
+  ClassInterface interface;
+  interface.name = ReadName(in);
+  interface.num_fields = ReadUInt16(in);
+  size_t num_subroutines = ReadUInt16(in);
+  for (size_t i = 0; i < num_subroutines; i++) {
+    char kind;
+    if (!in.get(kind)) {
+      throw std::runtime_error("Truncated class interface!");
+    }
+    auto keyword = static_cast<Token::Keyword>(kind);
+    if (keyword != kConstructor && keyword != kFunction && keyword != kMethod) {
+      throw std::runtime_error("Bad subroutine kind in class interface!");
+    }
+    int num_parameters = ReadUInt16(in);
+    interface.subroutines.push_back({ ReadName(in), keyword, num_parameters });
+  }
+  return interface;
+}
+
+std::string GetInterfacePath(const std::string& filename) {
+  boost::filesystem::path path(filename);
+  path.replace_extension(kInterfaceExtension);
+  return path.string();
+}
+
+ClassInterfaces::ClassInterfaces() {
+  for (const OSSubroutine& subroutine : kOSSubroutines) {
+    ClassInterface& interface = interfaces_[subroutine.class_name];
+    interface.name = subroutine.class_name;
+    interface.subroutines.push_back({ subroutine.name, subroutine.kind,
+                                      subroutine.num_parameters });
+  }
+}
+
+void ClassInterfaces::Add(ClassInterface interface) {
+  std::string name = interface.name;
+  interfaces_[name] = std::move(interface);
+}
+
+void ClassInterfaces::LoadDirectory(const std::string& directory) {
+  boost::system::error_code error;
+  for (const auto& entry : boost::filesystem::directory_iterator(directory, error)) {
+    if (entry.path().extension() != kInterfaceExtension) {
+      continue;
+    }
+    std::ifstream in(entry.path().string(), std::ios::binary);
+    try {
+      Add(ReadClassInterface(in));
+    } catch (const std::runtime_error&) {
+      continue;
+    }
+  }
+}
+
+const ClassInterface* ClassInterfaces::Find(std::string_view class_name) const {
+  auto it = interfaces_.find(class_name);
+  return it == interfaces_.end() ? nullptr : &it->second;
+}
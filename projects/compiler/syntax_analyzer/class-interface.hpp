@@ -0,0 +1,72 @@
+#ifndef SYNTAX_ANALYZER_CLASS_INTERFACE_HPP_
+#define SYNTAX_ANALYZER_CLASS_INTERFACE_HPP_
+
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "./ast.hpp"
+#include "./token.hpp"
+
+// What compiling a call into a class needs to know about it, without its
+// source: which subroutines it has, whether each is a constructor,
+// function or method, and how many parameters each takes.
+struct ClassInterface {
+  struct Subroutine {
+    std::string name;
+    // CONSTRUCTOR, FUNCTION or METHOD.
+    Token::Keyword kind;
+    int num_parameters;
+
+    bool operator==(const Subroutine& other) const;
+  };
+
+  static ClassInterface FromClass(const ClassNode& node);
+
+  // Returns null if the class has no subroutine called |name|.
+  const Subroutine* FindSubroutine(std::string_view name) const;
+
+  bool operator==(const ClassInterface& other) const;
+  bool operator!=(const ClassInterface& other) const { return !(*this == other); }
+
+  std::string name;
+  int num_fields = 0;
+  std::vector<Subroutine> subroutines;
+};
+
+// Interface files are a few dozen bytes per class: a magic number, then
+// length-prefixed names and 16-bit little-endian counts. Read throws
+// std::runtime_error on malformed input.
+void WriteClassInterface(const ClassInterface& interface, std::ostream& out);
+ClassInterface ReadClassInterface(std::istream& in);
+
+// Foo.jack or Foo.vm -> Foo.jci.
+std::string GetInterfacePath(const std::string& filename);
+
+// Interfaces of the classes a program can call into, by class name.
+class ClassInterfaces {
+ public:
+  // Starts out with the Jack OS classes of projects/12.
+  ClassInterfaces();
+
+  // Adds or replaces the interface of |interface.name|.
+  void Add(ClassInterface interface);
+  // Adds every Foo.jci found directly inside |directory|. Unreadable files
+  // are skipped, as the class then just compiles without checks.
+  void LoadDirectory(const std::string& directory);
+  // Returns null if the class is unknown.
+  const ClassInterface* Find(std::string_view class_name) const;
+
+  bool operator==(const ClassInterfaces& other) const {
+    return interfaces_ == other.interfaces_;
+  }
+
+ private:
+  std::map<std::string, ClassInterface, std::less<>> interfaces_;
+};
+
+#endif
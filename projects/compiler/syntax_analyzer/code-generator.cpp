@@ -0,0 +1,1003 @@
+#include "./code-generator.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr char kIfTrueLabel[] = "IF_TRUE";
+  constexpr char kIfFalseLabel[] = "IF_FALSE";
+  constexpr char kIfEndLabel[] = "IF_END";
+  constexpr char kWhileExpLabel[] = "WHILE_EXP";
+  constexpr char kWhileBodyLabel[] = "WHILE_BODY";
+  constexpr char kWhileEndLabel[] = "WHILE_END";
+  constexpr char kStringReadyLabel[] = "STRING_READY";
+
+  constexpr char kMathClass[] = "Math";
+  constexpr char kMultiplyFunction[] = "multiply";
+  constexpr char kDivideFunction[] = "divide";
+  constexpr char kMemoryClass[] = "Memory";
+  constexpr char kAllocFunction[] = "alloc";
+  constexpr char kStringClass[] = "String";
+  constexpr char kNewFunction[] = "new";
+  constexpr char kAppendCharFunction[] = "appendChar";
+
+  struct StringParameter {
+    std::string_view class_name;
+    std::string_view subroutine_name;
+  };
+
+  // OS subroutines that only read the String they are given and do not
+  // keep it. A literal passed straight to one of them can be built once
+  // and shared, since no caller can observe or mutate the copy.
+  constexpr StringParameter kReadOnlyStringParameters[] = {
+    { "Output", "printString" },
+    { "Keyboard", "readLine" },
+    { "Keyboard", "readInt" },
+  };
+
+  bool TakesReadOnlyString(std::string_view class_name, std::string_view subroutine_name) {
+    for (const StringParameter& parameter : kReadOnlyStringParameters) {
+      if (parameter.class_name == class_name &&
+          parameter.subroutine_name == subroutine_name) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool HasSubroutineCall(const ExpressionNode& node);
+
+  // Whether evaluating |node| may call a subroutine, which is the only
+  // way a Jack expression can change a variable.
+  bool HasSubroutineCall(const TermNode& node) {
+    switch (node.type) {
+      case TermNode::TermType::SUBROUTINE_CALL:
+        return true;
+      case TermNode::TermType::ARRAY_ELEMENT:
+      case TermNode::TermType::PARENTHESIZED:
+        return HasSubroutineCall(*node.expression);
+      case TermNode::TermType::UNARY_OP:
+        return HasSubroutineCall(*node.operand);
+      default:
+        return false;
+    }
+  }
+
+  bool HasSubroutineCall(const ExpressionNode& node) {
+    if (HasSubroutineCall(*node.first)) {
+      return true;
+    }
+    for (const OperationNode& operation : node.operations) {
+      if (HasSubroutineCall(*operation.term)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns the variable if |node| is nothing but a variable.
+  const Token* GetVariable(const ExpressionNode& node) {
+    if (!node.operations.empty() || node.first->type != TermNode::TermType::VARIABLE) {
+      return nullptr;
+    }
+    return &node.first->token;
+  }
+
+  // Returns the literal if |node| is nothing but a string constant.
+  const Token* GetStringLiteral(const ExpressionNode& node) {
+    if (!node.operations.empty() ||
+        node.first->type != TermNode::TermType::STRING_CONSTANT) {
+      return nullptr;
+    }
+    return &node.first->token;
+  }
+
+  // `pop temp 0` discards a value; array assignments park their value there.
+  constexpr int kScratchTempIndex = 0;
+  // Multiplications by a constant keep the multiplicand and the value
+  // being doubled here. Nothing else runs while they are live.
+  constexpr int kMultiplicandTempIndex = 1;
+  constexpr int kDoublingTempIndex = 2;
+  // Past these, a multiplication by a constant is smaller as a call to
+  // Math.multiply, which takes three commands, than as shift-and-add.
+  constexpr int kMaxMultiplierBits = 3;
+  constexpr int kMaxMultiplyCommands = 40;
+  // The largest value `push constant` accepts.
+  constexpr int kMaxPushConstant = 32767;
+  constexpr int kThisPointerIndex = 0;
+  constexpr int kThatPointerIndex = 1;
+
+  VMWriter::Segment GetSegment(SymbolTable::Kind kind) {
+    switch (kind) {
+      case SymbolTable::Kind::STATIC:
+        return VMWriter::Segment::STATIC;
+      case SymbolTable::Kind::FIELD:
+        return VMWriter::Segment::THIS;
+      case SymbolTable::Kind::ARG:
+        return VMWriter::Segment::ARGUMENT;
+      case SymbolTable::Kind::VAR:
+        return VMWriter::Segment::LOCAL;
+    }
+    throw std::logic_error("Unknown symbol kind");
+  }
+
+  // The declared type of a variable: a class name, or int, char or boolean.
+  std::string_view GetTypeName(const Token& type) {
+    if (type.GetType() == Token::TokenType::KEYWORD) {
+      return Token::KeywordToString(type.GetKeyword());
+    }
+    return type.GetIdentifier();
+  }
+
+  // Jack arithmetic is 16-bit two's complement and wraps around.
+  int16_t Wrap(int value) {
+    return static_cast<int16_t>(static_cast<uint16_t>(value));
+  }
+
+  bool EvaluateExpression(const ExpressionNode& node, int16_t* value);
+
+  // Computes |node| at compile time if it is built from integer constants
+  // and true, false and null only. Returns false otherwise.
+  bool EvaluateTerm(const TermNode& node, int16_t* value) {
+    int16_t operand;
+    switch (node.type) {
+      case TermNode::TermType::INT_CONSTANT:
+        *value = node.token.GetIntConstant();
+        return true;
+      case TermNode::TermType::KEYWORD_CONSTANT:
+        switch (node.token.GetKeyword()) {
+          case Token::Keyword::TRUE:
+            *value = -1;
+            return true;
+          case Token::Keyword::THIS:
+            return false;
+          default:
+            // false and null.
+            *value = 0;
+            return true;
+        }
+      case TermNode::TermType::PARENTHESIZED:
+        return EvaluateExpression(*node.expression, value);
+      case TermNode::TermType::UNARY_OP:
+        if (!EvaluateTerm(*node.operand, &operand)) {
+          return false;
+        }
+        *value = node.token.GetSymbol() == '-' ? Wrap(-operand) : Wrap(~operand);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // Applies |op| the way the VM and Math.multiply and Math.divide would.
+  // Returns false for a division that the OS would report as an error or
+  // whose result it does not define.
+  bool ApplyOperator(char op, int16_t left, int16_t right, int16_t* value) {
+    switch (op) {
+      case '+':
+        *value = Wrap(left + right);
+        return true;
+      case '-':
+        *value = Wrap(left - right);
+        return true;
+      case '*':
+        *value = Wrap(left * right);
+        return true;
+      case '/':
+        if (right == 0 || (left == INT16_MIN && right == -1)) {
+          return false;
+        }
+        // C++ division truncates toward zero, as Math.divide does.
+        *value = left / right;
+        return true;
+      case '&':
+        *value = left & right;
+        return true;
+      case '|':
+        *value = left | right;
+        return true;
+      case '<':
+        *value = left < right ? -1 : 0;
+        return true;
+      case '>':
+        *value = left > right ? -1 : 0;
+        return true;
+      case '=':
+        *value = left == right ? -1 : 0;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  bool EvaluateExpression(const ExpressionNode& node, int16_t* value) {
+    if (!EvaluateTerm(*node.first, value)) {
+      return false;
+    }
+    for (const OperationNode& operation : node.operations) {
+      int16_t operand;
+      if (!EvaluateTerm(*operation.term, &operand) ||
+          !ApplyOperator(operation.op.GetSymbol(), *value, operand, value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string DescribeLocation(const Token& token) {
+    return " at line " + std::to_string(token.GetLine()) +
+           ", column " + std::to_string(token.GetColumn());
+  }
+}
+
+void CodeGenerator::CompileClass(const ClassNode& node, int first_static) {
+  class_name_ = node.name.GetIdentifier();
+  class_interface_ = ClassInterface::FromClass(node);
+  first_static_ = first_static;
+  string_pool_.clear();
+  dropped_fields_.clear();
+  symbol_table_.StartClass();
+  for (const VarDecNode* var_dec : node.var_decs) {
+    SymbolTable::Kind kind = var_dec->keyword.GetKeyword() == Token::Keyword::STATIC ?
+      SymbolTable::Kind::STATIC : SymbolTable::Kind::FIELD;
+    for (const Token& name : var_dec->names) {
+      if (kind == SymbolTable::Kind::FIELD && program_ != nullptr &&
+          program_->IsFieldDropped(class_name_, name.GetIdentifier())) {
+        dropped_fields_.insert(name.GetIdentifier());
+        continue;
+      }
+      symbol_table_.Define(name.GetIdentifier(), GetTypeName(var_dec->type), kind);
+    }
+  }
+  for (const SubroutineDecNode* subroutine : node.subroutines) {
+    if (program_ == nullptr ||
+        program_->IsReachable(class_name_, subroutine->name.GetIdentifier())) {
+      CompileSubroutine(*subroutine);
+    }
+  }
+}
+
+int CodeGenerator::GetStaticCount() const {
+  return symbol_table_.GetCount(SymbolTable::Kind::STATIC) + string_pool_.size();
+}
+
+void CodeGenerator::CompileSubroutine(const SubroutineDecNode& node) {
+  symbol_table_.StartSubroutine();
+  if_label_count_ = 0;
+  while_label_count_ = 0;
+  string_label_count_ = 0;
+  ForgetThat();
+
+  Token::Keyword kind = node.keyword.GetKeyword();
+  if (kind == Token::Keyword::METHOD) {
+    // argument 0 is the object the method was called on.
+    symbol_table_.Define("this", class_name_, SymbolTable::Kind::ARG);
+  }
+  for (const ParameterNode& parameter : node.parameters) {
+    symbol_table_.Define(parameter.name.GetIdentifier(), GetTypeName(parameter.type),
+                         SymbolTable::Kind::ARG);
+  }
+  for (const VarDecNode* var_dec : node.body->var_decs) {
+    for (const Token& name : var_dec->names) {
+      symbol_table_.Define(name.GetIdentifier(), GetTypeName(var_dec->type),
+                           SymbolTable::Kind::VAR);
+    }
+  }
+
+  writer_->WriteFunction(class_name_, node.name.GetIdentifier(),
+                         symbol_table_.GetCount(SymbolTable::Kind::VAR));
+  if (kind == Token::Keyword::CONSTRUCTOR) {
+    writer_->WritePush(VMWriter::Segment::CONSTANT,
+                       symbol_table_.GetCount(SymbolTable::Kind::FIELD));
+    WriteCall(kMemoryClass, kAllocFunction, 1);
+    writer_->WritePop(VMWriter::Segment::POINTER, kThisPointerIndex);
+  } else if (kind == Token::Keyword::METHOD) {
+    writer_->WritePush(VMWriter::Segment::ARGUMENT, 0);
+    writer_->WritePop(VMWriter::Segment::POINTER, kThisPointerIndex);
+  }
+  CompileStatements(node.body->statements);
+}
+
+void CodeGenerator::CompileStatements(const ArenaArray<StatementNode*>& statements) {
+  for (const StatementNode* statement : statements) {
+    switch (statement->type) {
+      case StatementNode::StatementType::LET:
+        CompileLetStatement(*statement);
+        break;
+      case StatementNode::StatementType::IF:
+        CompileIfStatement(*statement);
+        break;
+      case StatementNode::StatementType::WHILE:
+        CompileWhileStatement(*statement);
+        break;
+      case StatementNode::StatementType::DO:
+        CompileDoStatement(*statement);
+        break;
+      case StatementNode::StatementType::RETURN:
+        CompileReturnStatement(*statement);
+        break;
+    }
+  }
+}
+
+void CodeGenerator::CompileLetStatement(const StatementNode& node) {
+  if (node.index == nullptr && symbol_table_.Find(node.var_name.GetIdentifier()) == nullptr &&
+      dropped_fields_.count(node.var_name.GetIdentifier()) != 0) {
+    // Nothing reads the field, but the value may have side effects.
+    CompileExpression(*node.expression);
+    writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+    return;
+  }
+  if (node.index == nullptr) {
+    CompileExpression(*node.expression);
+    PopVariable(node.var_name);
+    return;
+  }
+
+  // Without calls on either side, evaluation order cannot be observed, so
+  // the value goes first and `that` is pointed at the element last, where
+  // nothing can move it before the store.
+  if (!HasSubroutineCall(*node.index) && !HasSubroutineCall(*node.expression)) {
+    CompileExpression(*node.expression);
+    int offset = PointThatAt(node.var_name, *node.index);
+    writer_->WritePop(VMWriter::Segment::THAT, offset);
+    return;
+  }
+
+  // Otherwise the element's address is computed first, as in the reference
+  // compiler, and parked while the value expression, which may index
+  // arrays itself, runs.
+  CompileExpression(*node.index);
+  PushVariable(node.var_name);
+  writer_->WriteArithmetic(VMWriter::Command::ADD);
+  CompileExpression(*node.expression);
+  writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+  writer_->WritePop(VMWriter::Segment::POINTER, kThatPointerIndex);
+  ForgetThat();
+  writer_->WritePush(VMWriter::Segment::TEMP, kScratchTempIndex);
+  writer_->WritePop(VMWriter::Segment::THAT, 0);
+}
+
+void CodeGenerator::CompileIfStatement(const StatementNode& node) {
+  // The then part runs if the condition is not 0.
+  int label = if_label_count_++;
+  Condition condition = CompileCondition(*node.expression);
+  if (condition == Condition::TRUE_IF_ZERO || condition == Condition::TRUE_IF_ZERO_BOOLEAN) {
+    // Branch past the then part on a nonzero value.
+    writer_->WriteIf(kIfFalseLabel, label);
+  } else if (node.has_else) {
+    // Branch to the then part and fall through into the else part.
+    writer_->WriteIf(kIfTrueLabel, label);
+    CompileStatements(node.else_statements);
+    writer_->WriteGoto(kIfEndLabel, label);
+    WriteLabel(kIfTrueLabel, label);
+    CompileStatements(node.statements);
+    WriteLabel(kIfEndLabel, label);
+    return;
+  } else if (condition == Condition::TRUE_IF_MINUS_ONE) {
+    writer_->WriteArithmetic(VMWriter::Command::NOT);
+    writer_->WriteIf(kIfFalseLabel, label);
+  } else {
+    // `not` of any other value may be true as well.
+    writer_->WriteIf(kIfTrueLabel, label);
+    writer_->WriteGoto(kIfFalseLabel, label);
+    WriteLabel(kIfTrueLabel, label);
+  }
+  CompileStatements(node.statements);
+  if (node.has_else) {
+    writer_->WriteGoto(kIfEndLabel, label);
+  }
+  WriteLabel(kIfFalseLabel, label);
+  if (node.has_else) {
+    CompileStatements(node.else_statements);
+    WriteLabel(kIfEndLabel, label);
+  }
+}
+
+void CodeGenerator::CompileWhileStatement(const StatementNode& node) {
+  int label = while_label_count_++;
+  int16_t value;
+  if (EvaluateExpression(*node.expression, &value) && value == -1) {
+    WriteLabel(kWhileExpLabel, label);
+    CompileStatements(node.statements);
+    writer_->WriteGoto(kWhileExpLabel, label);
+    return;
+  }
+  // The condition is tested at the bottom, so that an iteration takes just
+  // the branch back to the body.
+  writer_->WriteGoto(kWhileExpLabel, label);
+  WriteLabel(kWhileBodyLabel, label);
+  CompileStatements(node.statements);
+  WriteLabel(kWhileExpLabel, label);
+  Condition condition = CompileCondition(*node.expression);
+  if (condition == Condition::UNKNOWN) {
+    // The body runs while the condition is -1, as `not` then makes it 0.
+    writer_->WriteArithmetic(VMWriter::Command::NOT);
+    condition = Condition::TRUE_IF_ZERO;
+  }
+  switch (condition) {
+    case Condition::TRUE_IF_NONZERO:
+    case Condition::TRUE_IF_MINUS_ONE:
+      writer_->WriteIf(kWhileBodyLabel, label);
+      break;
+    case Condition::TRUE_IF_ZERO_BOOLEAN:
+      writer_->WriteArithmetic(VMWriter::Command::NOT);
+      writer_->WriteIf(kWhileBodyLabel, label);
+      break;
+    default:
+      writer_->WriteIf(kWhileEndLabel, label);
+      writer_->WriteGoto(kWhileBodyLabel, label);
+      WriteLabel(kWhileEndLabel, label);
+      break;
+  }
+}
+
+void CodeGenerator::CompileDoStatement(const StatementNode& node) {
+  CompileSubroutineCall(*node.call, false);
+}
+
+void CodeGenerator::CompileReturnStatement(const StatementNode& node) {
+  if (node.expression != nullptr) {
+    CompileExpression(*node.expression);
+  } else {
+    writer_->WritePush(VMWriter::Segment::CONSTANT, 0);
+  }
+  writer_->WriteReturn();
+}
+
+void CodeGenerator::CompileExpression(const ExpressionNode& node) {
+  CompileExpression(node, node.operations.size());
+}
+
+void CodeGenerator::CompileExpression(const ExpressionNode& node, size_t num_operations) {
+  // Fold the longest prefix of the expression that is made of constants.
+  size_t next_operation = 0;
+  int16_t value;
+  if (EvaluateTerm(*node.first, &value)) {
+    int16_t operand;
+    while (next_operation < num_operations &&
+           EvaluateTerm(*node.operations[next_operation].term, &operand) &&
+           ApplyOperator(node.operations[next_operation].op.GetSymbol(),
+                         value, operand, &value)) {
+      next_operation++;
+    }
+    char op = next_operation < num_operations ?
+      node.operations[next_operation].op.GetSymbol() : '\0';
+    if (op == '*' || op == '+' || op == '&' || op == '|') {
+      // c op x: the operation commutes, so compute x and apply it to c.
+      CompileTerm(*node.operations[next_operation].term);
+      if (!CompileConstantOperation(op, value)) {
+        PushConstant(value);
+        CompileOperator(node.operations[next_operation].op);
+      }
+      next_operation++;
+    } else if (op == '-' && value == 0) {
+      CompileTerm(*node.operations[next_operation].term);
+      writer_->WriteArithmetic(VMWriter::Command::NEG);
+      next_operation++;
+    } else {
+      PushConstant(value);
+    }
+  } else {
+    CompileTerm(*node.first);
+  }
+
+  for (size_t i = next_operation; i < num_operations; i++) {
+    const OperationNode& operation = node.operations[i];
+    int16_t operand;
+    if (!EvaluateTerm(*operation.term, &operand)) {
+      CompileTerm(*operation.term);
+      CompileOperator(operation.op);
+    } else if (!CompileConstantOperation(operation.op.GetSymbol(), operand)) {
+      PushConstant(operand);
+      CompileOperator(operation.op);
+    }
+  }
+}
+
+bool CodeGenerator::CompileConstantOperation(char op, int16_t operand) {
+  switch (op) {
+    case '*':
+      return CompileMultiplyByConstant(operand);
+    case '+':
+    case '-':
+      if (operand == 0) {
+        return true;
+      }
+      // x + -k is x - k, and x - -k is x + k, saving the neg.
+      if (operand < 0 && operand != INT16_MIN) {
+        writer_->WritePush(VMWriter::Segment::CONSTANT, -operand);
+        writer_->WriteArithmetic(op == '+' ? VMWriter::Command::SUB : VMWriter::Command::ADD);
+        return true;
+      }
+      return false;
+    case '&':
+    case '|':
+      // x & -1 and x | 0 are x; x & 0 is 0 and x | -1 is -1.
+      if (operand == (op == '&' ? -1 : 0)) {
+        return true;
+      }
+      if (operand == (op == '&' ? 0 : -1)) {
+        writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+        PushConstant(operand);
+        return true;
+      }
+      return false;
+    case '/':
+      // The VM has no right shift, so only the trivial divisions avoid
+      // Math.divide.
+      if (operand == 1) {
+        return true;
+      }
+      if (operand == -1) {
+        writer_->WriteArithmetic(VMWriter::Command::NEG);
+        return true;
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+bool CodeGenerator::CompileMultiplyByConstant(int16_t factor) {
+  if (factor == 0) {
+    writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+    writer_->WritePush(VMWriter::Segment::CONSTANT, 0);
+    return true;
+  }
+  bool negate = factor < 0 && factor != INT16_MIN;
+  // INT16_MIN is 0x8000 either way: a single shift.
+  uint16_t multiplier = negate ? -factor : static_cast<uint16_t>(factor);
+
+  // Shift-and-add over the multiplier's bits, highest first. Doubling the
+  // value on top of the stack takes a round trip through a temp, since
+  // the VM cannot duplicate it; that is still a few commands per bit
+  // against Math.multiply's sixteen-step loop and call. Every bit costs
+  // code, though, so a dense or large multiplier keeps the call.
+  int top_bit = 15;
+  while ((multiplier & (1 << top_bit)) == 0) {
+    top_bit--;
+  }
+  int set_bits = 0;
+  for (uint16_t bits = multiplier; bits != 0; bits &= bits - 1) {
+    set_bits++;
+  }
+  bool needs_multiplicand = set_bits > 1;
+  int num_commands = (needs_multiplicand ? 2 : 0) + 4 * top_bit + 2 * (set_bits - 1) +
+                     (negate ? 1 : 0);
+  if (set_bits > kMaxMultiplierBits || num_commands > kMaxMultiplyCommands) {
+    return false;
+  }
+  if (needs_multiplicand) {
+    writer_->WritePop(VMWriter::Segment::TEMP, kMultiplicandTempIndex);
+    writer_->WritePush(VMWriter::Segment::TEMP, kMultiplicandTempIndex);
+  }
+  for (int bit = top_bit - 1; bit >= 0; bit--) {
+    writer_->WritePop(VMWriter::Segment::TEMP, kDoublingTempIndex);
+    writer_->WritePush(VMWriter::Segment::TEMP, kDoublingTempIndex);
+    writer_->WritePush(VMWriter::Segment::TEMP, kDoublingTempIndex);
+    writer_->WriteArithmetic(VMWriter::Command::ADD);
+    if ((multiplier & (1 << bit)) != 0) {
+      writer_->WritePush(VMWriter::Segment::TEMP, kMultiplicandTempIndex);
+      writer_->WriteArithmetic(VMWriter::Command::ADD);
+    }
+  }
+  if (negate) {
+    writer_->WriteArithmetic(VMWriter::Command::NEG);
+  }
+  return true;
+}
+
+void CodeGenerator::PushConstant(int16_t value) {
+  if (value >= 0) {
+    writer_->WritePush(VMWriter::Segment::CONSTANT, value);
+  } else if (value == -1) {
+    // As true is written.
+    writer_->WritePush(VMWriter::Segment::CONSTANT, 0);
+    writer_->WriteArithmetic(VMWriter::Command::NOT);
+  } else if (value == INT16_MIN) {
+    writer_->WritePush(VMWriter::Segment::CONSTANT, kMaxPushConstant);
+    writer_->WriteArithmetic(VMWriter::Command::NOT);
+  } else {
+    writer_->WritePush(VMWriter::Segment::CONSTANT, -value);
+    writer_->WriteArithmetic(VMWriter::Command::NEG);
+  }
+}
+
+void CodeGenerator::CompileTerm(const TermNode& node) {
+  switch (node.type) {
+    case TermNode::TermType::INT_CONSTANT:
+      writer_->WritePush(VMWriter::Segment::CONSTANT, node.token.GetIntConstant());
+      break;
+    case TermNode::TermType::STRING_CONSTANT:
+      CompileStringConstant(node.token.GetStringConstant());
+      break;
+    case TermNode::TermType::KEYWORD_CONSTANT:
+      CompileKeywordConstant(node.token);
+      break;
+    case TermNode::TermType::VARIABLE:
+      PushVariable(node.token);
+      break;
+    case TermNode::TermType::ARRAY_ELEMENT:
+      writer_->WritePush(VMWriter::Segment::THAT, PointThatAt(node.token, *node.expression));
+      break;
+    case TermNode::TermType::SUBROUTINE_CALL:
+      CompileSubroutineCall(*node.call);
+      break;
+    case TermNode::TermType::PARENTHESIZED:
+      CompileExpression(*node.expression);
+      break;
+    case TermNode::TermType::UNARY_OP:
+      CompileTerm(*node.operand);
+      writer_->WriteArithmetic(node.token.GetSymbol() == '-' ?
+        VMWriter::Command::NEG : VMWriter::Command::NOT);
+      break;
+  }
+}
+
+void CodeGenerator::CompileKeywordConstant(const Token& keyword) {
+  switch (keyword.GetKeyword()) {
+    case Token::Keyword::TRUE:
+      writer_->WritePush(VMWriter::Segment::CONSTANT, 0);
+      writer_->WriteArithmetic(VMWriter::Command::NOT);
+      break;
+    case Token::Keyword::THIS:
+      writer_->WritePush(VMWriter::Segment::POINTER, kThisPointerIndex);
+      break;
+    default:
+      // false and null.
+      writer_->WritePush(VMWriter::Segment::CONSTANT, 0);
+      break;
+  }
+}
+
+void CodeGenerator::CompileStringConstant(std::string_view text) {
+  writer_->WritePush(VMWriter::Segment::CONSTANT, static_cast<int>(text.size()));
+  WriteCall(kStringClass, kNewFunction, 1);
+  for (char c : text) {
+    writer_->WritePush(VMWriter::Segment::CONSTANT, static_cast<unsigned char>(c));
+    WriteCall(kStringClass, kAppendCharFunction, 2);
+  }
+}
+
+void CodeGenerator::CompilePooledStringConstant(std::string_view text) {
+  // Every distinct literal gets a static past the class's own, which holds
+  // the String once the first use has built it.
+  auto inserted = string_pool_.emplace(
+    text, first_static_ + GetStaticCount());
+  int index = inserted.first->second;
+  int label = string_label_count_++;
+  writer_->WritePush(VMWriter::Segment::STATIC, index);
+  writer_->WriteIf(kStringReadyLabel, label);
+  CompileStringConstant(text);
+  writer_->WritePop(VMWriter::Segment::STATIC, index);
+  WriteLabel(kStringReadyLabel, label);
+  writer_->WritePush(VMWriter::Segment::STATIC, index);
+}
+
+void CodeGenerator::CompileSubroutineCall(const SubroutineCallNode& node, bool value_used) {
+  std::string_view class_name = class_name_;
+  const SymbolTable::Symbol* receiver = nullptr;
+  if (node.has_receiver) {
+    receiver = symbol_table_.Find(node.receiver.GetIdentifier());
+    class_name = receiver != nullptr ? receiver->type : node.receiver.GetIdentifier();
+  }
+  // foo(...) is a method call on this object and var.foo(...) one on the
+  // object stored in var; Class.foo(...) is a function or constructor call.
+  bool is_method_call = !node.has_receiver || receiver != nullptr;
+
+  int n_args = node.arguments.size();
+  if (const ClassInterface::Subroutine* callee = FindCallee(class_name, node)) {
+    std::string callee_name = std::string(class_name) + '.' + callee->name;
+    if (callee->num_parameters != n_args) {
+      throw std::runtime_error(callee_name + " takes " +
+                               std::to_string(callee->num_parameters) +
+                               (callee->num_parameters == 1 ? " argument" : " arguments") +
+                               ", not " + std::to_string(n_args) +
+                               DescribeLocation(node.name));
+    }
+    bool is_method = callee->kind == Token::Keyword::METHOD;
+    if (!node.has_receiver) {
+      is_method_call = is_method;
+    } else if (is_method != is_method_call) {
+      throw std::runtime_error(callee_name + (is_method ?
+                               " is a method; call it on an object" :
+                               " is not a method; call it on its class") +
+                               DescribeLocation(node.name));
+    }
+  }
+
+  if (is_method_call && program_ != nullptr) {
+    const ProgramOptimizer::Accessor* accessor =
+      program_->FindAccessor(class_name, node.name.GetIdentifier());
+    if (accessor != nullptr) {
+      CompileInlineAccessor(node, receiver != nullptr, *accessor, value_used);
+      return;
+    }
+  }
+
+  if (is_method_call) {
+    if (receiver != nullptr) {
+      PushVariable(node.receiver);
+    } else {
+      writer_->WritePush(VMWriter::Segment::POINTER, kThisPointerIndex);
+    }
+    n_args++;
+  }
+  bool pool_strings = TakesReadOnlyString(class_name, node.name.GetIdentifier());
+  for (const ExpressionNode* argument : node.arguments) {
+    const Token* literal = pool_strings ? GetStringLiteral(*argument) : nullptr;
+    if (literal != nullptr) {
+      CompilePooledStringConstant(literal->GetStringConstant());
+    } else {
+      CompileExpression(*argument);
+    }
+  }
+  WriteCall(class_name, node.name.GetIdentifier(), n_args);
+  if (!value_used) {
+    writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+  }
+}
+
+void CodeGenerator::CompileInlineAccessor(const SubroutineCallNode& node, bool has_receiver,
+                                          const ProgramOptimizer::Accessor& accessor,
+                                          bool value_used) {
+  int field = accessor.field_index;
+  if (!accessor.is_setter) {
+    // Reading a field has no effect worth keeping if the value is unused.
+    if (!value_used) {
+      return;
+    }
+    if (has_receiver) {
+      PointThatAtVariable(node.receiver);
+      writer_->WritePush(VMWriter::Segment::THAT, field);
+    } else {
+      writer_->WritePush(VMWriter::Segment::THIS, field);
+    }
+    return;
+  }
+
+  const ExpressionNode& value = *node.arguments[0];
+  if (field < 0) {
+    CompileExpression(value);
+    writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+  } else if (!has_receiver) {
+    CompileExpression(value);
+    writer_->WritePop(VMWriter::Segment::THIS, field);
+  } else if (!HasSubroutineCall(value)) {
+    CompileExpression(value);
+    PointThatAtVariable(node.receiver);
+    writer_->WritePop(VMWriter::Segment::THAT, field);
+  } else {
+    // The receiver is read before the argument runs, as for a real call.
+    PushVariable(node.receiver);
+    CompileExpression(value);
+    writer_->WritePop(VMWriter::Segment::TEMP, kScratchTempIndex);
+    writer_->WritePop(VMWriter::Segment::POINTER, kThatPointerIndex);
+    writer_->WritePush(VMWriter::Segment::TEMP, kScratchTempIndex);
+    writer_->WritePop(VMWriter::Segment::THAT, field);
+  }
+  // The field may be a variable that `that` was computed from.
+  ForgetThat();
+  if (value_used) {
+    // What a void setter returns.
+    writer_->WritePush(VMWriter::Segment::CONSTANT, 0);
+  }
+}
+
+const ClassInterface::Subroutine* CodeGenerator::FindCallee(
+    std::string_view class_name, const SubroutineCallNode& node) const {
+  const ClassInterface* interface = nullptr;
+  if (class_name == class_name_) {
+    interface = &class_interface_;
+  } else if (interfaces_ != nullptr) {
+    interface = interfaces_->Find(class_name);
+  }
+  if (interface == nullptr) {
+    return nullptr;
+  }
+  const ClassInterface::Subroutine* callee =
+    interface->FindSubroutine(node.name.GetIdentifier());
+  if (callee == nullptr) {
+    throw std::runtime_error("Undefined subroutine " + std::string(class_name) + '.' +
+                             std::string(node.name.GetIdentifier()) +
+                             DescribeLocation(node.name));
+  }
+  return callee;
+}
+
+void CodeGenerator::CompileOperator(const Token& op) {
+  switch (op.GetSymbol()) {
+    case '+':
+      writer_->WriteArithmetic(VMWriter::Command::ADD);
+      break;
+    case '-':
+      writer_->WriteArithmetic(VMWriter::Command::SUB);
+      break;
+    case '*':
+      WriteCall(kMathClass, kMultiplyFunction, 2);
+      break;
+    case '/':
+      WriteCall(kMathClass, kDivideFunction, 2);
+      break;
+    case '&':
+      writer_->WriteArithmetic(VMWriter::Command::AND);
+      break;
+    case '|':
+      writer_->WriteArithmetic(VMWriter::Command::OR);
+      break;
+    case '<':
+      writer_->WriteArithmetic(VMWriter::Command::LT);
+      break;
+    case '>':
+      writer_->WriteArithmetic(VMWriter::Command::GT);
+      break;
+    case '=':
+      writer_->WriteArithmetic(VMWriter::Command::EQ);
+      break;
+    default:
+      throw std::runtime_error(std::string("Unknown operator ") + op.GetSymbol() +
+                               DescribeLocation(op));
+  }
+}
+
+void CodeGenerator::PushVariable(const Token& name) {
+  const SymbolTable::Symbol& symbol = LookUp(name);
+  writer_->WritePush(GetSegment(symbol.kind), GetIndex(symbol));
+}
+
+void CodeGenerator::PopVariable(const Token& name) {
+  const SymbolTable::Symbol& symbol = LookUp(name);
+  writer_->WritePop(GetSegment(symbol.kind), GetIndex(symbol));
+  if (that_is_known_ && (name.GetIdentifier() == that_base_ ||
+                         name.GetIdentifier() == that_index_)) {
+    ForgetThat();
+  }
+}
+
+int CodeGenerator::PointThatAt(const Token& base, const ExpressionNode& index) {
+  std::string_view base_name = base.GetIdentifier();
+  int16_t offset;
+  if (EvaluateExpression(index, &offset) && offset >= 0) {
+    // a[k] is `that k` with `that` at a itself.
+    PointThatAtVariable(base);
+    return offset;
+  }
+
+  const Token* index_variable = GetVariable(index);
+  std::string_view index_name = index_variable != nullptr ?
+    index_variable->GetIdentifier() : std::string_view();
+  if (index_variable != nullptr && that_is_known_ && that_base_ == base_name &&
+      that_index_ == index_name) {
+    return 0;
+  }
+  CompileExpression(index);
+  PushVariable(base);
+  writer_->WriteArithmetic(VMWriter::Command::ADD);
+  writer_->WritePop(VMWriter::Segment::POINTER, kThatPointerIndex);
+  if (index_variable != nullptr) {
+    RememberThat(base_name, index_name);
+  } else {
+    ForgetThat();
+  }
+  return 0;
+}
+
+void CodeGenerator::PointThatAtVariable(const Token& base) {
+  std::string_view base_name = base.GetIdentifier();
+  if (!that_is_known_ || that_base_ != base_name || !that_index_.empty()) {
+    PushVariable(base);
+    writer_->WritePop(VMWriter::Segment::POINTER, kThatPointerIndex);
+    RememberThat(base_name, std::string_view());
+  }
+}
+
+void CodeGenerator::RememberThat(std::string_view base, std::string_view index) {
+  that_is_known_ = true;
+  that_base_ = base;
+  that_index_ = index;
+}
+
+void CodeGenerator::ForgetThat() {
+  that_is_known_ = false;
+}
+
+void CodeGenerator::WriteLabel(std::string_view prefix, int index) {
+  writer_->WriteLabel(prefix, index);
+  // Control can arrive here from elsewhere, with `that` anywhere.
+  ForgetThat();
+}
+
+void CodeGenerator::WriteCall(std::string_view class_name,
+                              std::string_view subroutine_name, int n_args) {
+  writer_->WriteCall(class_name, subroutine_name, n_args);
+  // The callee may have used `that` and may have changed any field or
+  // static.
+  ForgetThat();
+}
+
+int CodeGenerator::GetIndex(const SymbolTable::Symbol& symbol) const {
+  return symbol.kind == SymbolTable::Kind::STATIC ? first_static_ + symbol.index : symbol.index;
+}
+
+bool CodeGenerator::IsBoolean(const TermNode& node) const {
+  switch (node.type) {
+    case TermNode::TermType::KEYWORD_CONSTANT:
+      return node.token.GetKeyword() != Token::Keyword::THIS;
+    case TermNode::TermType::PARENTHESIZED:
+      return IsBoolean(*node.expression);
+    case TermNode::TermType::UNARY_OP:
+      return node.token.GetSymbol() == '~' && IsBoolean(*node.operand);
+    default:
+      return false;
+  }
+}
+
+bool CodeGenerator::IsBoolean(const ExpressionNode& node) const {
+  if (node.operations.size() == 0) {
+    return IsBoolean(*node.first);
+  }
+  char op = node.operations[node.operations.size() - 1].op.GetSymbol();
+  return op == '<' || op == '>' || op == '=';
+}
+
+CodeGenerator::Condition CodeGenerator::CompileCondition(const ExpressionNode& node) {
+  int16_t value;
+  if (EvaluateExpression(node, &value)) {
+    PushConstant(value);
+    return value == 0 || value == -1 ? Condition::TRUE_IF_MINUS_ONE : Condition::UNKNOWN;
+  }
+  size_t num_operations = node.operations.size();
+  if (num_operations != 0 &&
+      node.operations[num_operations - 1].op.GetSymbol() == '=') {
+    // e = t is true if e - t is 0, so the eq can be a sub.
+    CompileExpression(node, num_operations - 1);
+    const TermNode& term = *node.operations[num_operations - 1].term;
+    int16_t operand;
+    if (!EvaluateTerm(term, &operand)) {
+      CompileTerm(term);
+      writer_->WriteArithmetic(VMWriter::Command::SUB);
+    } else if (!CompileConstantOperation('-', operand)) {
+      PushConstant(operand);
+      writer_->WriteArithmetic(VMWriter::Command::SUB);
+    }
+    return Condition::TRUE_IF_ZERO;
+  }
+  const TermNode& term = *node.first;
+  if (num_operations == 0 && term.type == TermNode::TermType::UNARY_OP &&
+      term.token.GetSymbol() == '~') {
+    const TermNode& operand = *term.operand;
+    if (operand.type == TermNode::TermType::PARENTHESIZED) {
+      // The operand is tested the other way around.
+      switch (CompileCondition(*operand.expression)) {
+        case Condition::TRUE_IF_ZERO:
+          return Condition::TRUE_IF_NONZERO;
+        case Condition::TRUE_IF_NONZERO:
+          return Condition::TRUE_IF_ZERO;
+        case Condition::TRUE_IF_MINUS_ONE:
+          return Condition::TRUE_IF_ZERO_BOOLEAN;
+        case Condition::TRUE_IF_ZERO_BOOLEAN:
+          return Condition::TRUE_IF_MINUS_ONE;
+        case Condition::UNKNOWN:
+          writer_->WriteArithmetic(VMWriter::Command::NOT);
+          return Condition::UNKNOWN;
+      }
+    }
+    if (IsBoolean(operand)) {
+      CompileTerm(operand);
+      return Condition::TRUE_IF_ZERO_BOOLEAN;
+    }
+  }
+  CompileExpression(node);
+  return IsBoolean(node) ? Condition::TRUE_IF_MINUS_ONE : Condition::UNKNOWN;
+}
+
+const SymbolTable::Symbol& CodeGenerator::LookUp(const Token& name) const {
+  const SymbolTable::Symbol* symbol = symbol_table_.Find(name.GetIdentifier());
+  if (symbol == nullptr) {
+    throw std::runtime_error("Undefined variable " + std::string(name.GetIdentifier()) +
+                             DescribeLocation(name));
+  }
+  return *symbol;
+}
@@ -0,0 +1,153 @@
+#ifndef SYNTAX_ANALYZER_CODE_GENERATOR_HPP_
+#define SYNTAX_ANALYZER_CODE_GENERATOR_HPP_
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "./ast.hpp"
+#include "./class-interface.hpp"
+#include "./program-optimizer.hpp"
+#include "./symbol-table.hpp"
+#include "./vm-writer.hpp"
+
+// Compiles the syntax tree of a Jack class to VM code in a single walk.
+// The output follows the conventions of the nand2tetris reference
+// compiler: the same calling sequences for constructors, methods and
+// functions, and the same array and string constant code.
+//
+// Control flow is laid out to branch as little as possible. Loops test
+// their condition at the bottom, so an iteration takes a single if-goto,
+// and an if without an else has no empty else part to jump over. A branch
+// on e = t tests e - t instead, and a branch on ~c tests c the other way.
+// A `not` is only folded into a branch on a condition that is known to be
+// 0 or -1: a comparison, true, false or null, or ~ of one of those. A
+// variable declared boolean may hold any value, so it does not count, and
+// other values behave as in the reference compiler.
+//
+// Expressions made of integer constants and true, false and null only are
+// folded, and multiplications by a constant with few set bits become
+// shift-and-add sequences instead of calls to Math.multiply. String
+// literals passed straight to the OS's printing and prompting subroutines
+// are built on first use and kept in a static, rather than allocated anew
+// every time.
+//
+// Operations that leave their operand unchanged, such as x + 0 or x & -1,
+// are dropped, and x + -k becomes x - k.
+//
+// Within straight-line code the generator remembers which element `that`
+// points at: a[k] for a constant k uses `that k` with `that` at a, and
+// repeated a[i] with an unchanged a and i reuse `pointer 1` as is.
+//
+// Calls into the class itself, and into classes that |interfaces| knows,
+// are checked against the callee's declaration, and a bare foo() that
+// names a function rather than a method compiles to a function call.
+// Calls into other classes are compiled unchecked.
+//
+// Given a ProgramOptimizer for the whole program, unreachable subroutines
+// and unread fields are left out and accessor calls are compiled inline.
+class CodeGenerator {
+ public:
+  explicit CodeGenerator(VMWriter* writer,
+                         const ClassInterfaces* interfaces = nullptr,
+                         const ProgramOptimizer* program = nullptr) :
+    writer_(writer), interfaces_(interfaces), program_(program), first_static_(0),
+    if_label_count_(0),
+    while_label_count_(0), string_label_count_(0), that_is_known_(false) {}
+
+  // Throws std::runtime_error on semantic errors such as undefined
+  // variables or calls that do not match the callee's declaration. The
+  // class's statics are numbered from |first_static|, so that several
+  // classes can share one VM file.
+  void CompileClass(const ClassNode& node, int first_static = 0);
+  // Statics used by the last class compiled, its own and pooled strings'.
+  int GetStaticCount() const;
+
+ private:
+  // What the value a condition compiles to says about the condition.
+  enum class Condition {
+    // True if the value is 0, and false otherwise.
+    TRUE_IF_ZERO,
+    TRUE_IF_NONZERO,
+    // The value is 0 or -1, and true if -1.
+    TRUE_IF_MINUS_ONE,
+    // The value is 0 or -1, and true if 0.
+    TRUE_IF_ZERO_BOOLEAN,
+    // The value is the condition itself.
+    UNKNOWN
+  };
+
+  void CompileSubroutine(const SubroutineDecNode& node);
+  void CompileStatements(const ArenaArray<StatementNode*>& statements);
+  void CompileLetStatement(const StatementNode& node);
+  void CompileIfStatement(const StatementNode& node);
+  void CompileWhileStatement(const StatementNode& node);
+  void CompileDoStatement(const StatementNode& node);
+  void CompileReturnStatement(const StatementNode& node);
+  void CompileExpression(const ExpressionNode& node);
+  // Compiles just the first term and |num_operations| operations.
+  void CompileExpression(const ExpressionNode& node, size_t num_operations);
+  // Applies |op| with a constant right operand to the value on top of the
+  // stack, if there is something better than pushing it and calling
+  // CompileOperator. Returns false if not.
+  bool CompileConstantOperation(char op, int16_t operand);
+  // Returns false, having written nothing, if Math.multiply is shorter.
+  bool CompileMultiplyByConstant(int16_t factor);
+  void PushConstant(int16_t value);
+  void CompileTerm(const TermNode& node);
+  void CompileKeywordConstant(const Token& keyword);
+  void CompileStringConstant(std::string_view text);
+  void CompilePooledStringConstant(std::string_view text);
+  // Leaves the call's value on the stack unless |value_used| is false.
+  void CompileSubroutineCall(const SubroutineCallNode& node, bool value_used = true);
+  void CompileInlineAccessor(const SubroutineCallNode& node, bool has_receiver,
+                             const ProgramOptimizer::Accessor& accessor, bool value_used);
+  const ClassInterface::Subroutine* FindCallee(std::string_view class_name,
+                                               const SubroutineCallNode& node) const;
+  void CompileOperator(const Token& op);
+  // True if the value can only be 0 or -1, so that `not` negates it.
+  bool IsBoolean(const TermNode& node) const;
+  bool IsBoolean(const ExpressionNode& node) const;
+  // Pushes a value that a branch on |node| can test in place of |node|
+  // itself, and returns how to read it.
+  Condition CompileCondition(const ExpressionNode& node);
+  void PushVariable(const Token& name);
+  void PopVariable(const Token& name);
+  // Points `that` at |base|[|index|], or at |base| for a constant index,
+  // unless it is there already, and returns the `that` offset of the
+  // element.
+  int PointThatAt(const Token& base, const ExpressionNode& index);
+  void PointThatAtVariable(const Token& base);
+  // `that` is |base|, plus |index| unless that is empty.
+  void RememberThat(std::string_view base, std::string_view index);
+  void ForgetThat();
+  // Every label and call goes through these, since either may leave
+  // `that` pointing anywhere.
+  void WriteLabel(std::string_view prefix, int index);
+  void WriteCall(std::string_view class_name, std::string_view subroutine_name,
+                 int n_args);
+  // The symbol's index in its VM segment.
+  int GetIndex(const SymbolTable::Symbol& symbol) const;
+  const SymbolTable::Symbol& LookUp(const Token& name) const;
+
+  VMWriter* writer_;
+  const ClassInterfaces* interfaces_;
+  const ProgramOptimizer* program_;
+  int first_static_;
+  SymbolTable symbol_table_;
+  // Fields the program never reads; they have no symbol.
+  std::unordered_set<std::string_view> dropped_fields_;
+  std::string_view class_name_;
+  ClassInterface class_interface_;
+  int if_label_count_;
+  int while_label_count_;
+  int string_label_count_;
+  // Static index of each pooled literal of the class.
+  std::unordered_map<std::string_view, int> string_pool_;
+  bool that_is_known_;
+  std::string_view that_base_;
+  std::string_view that_index_;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "./compilation-engine.hpp"
-#include "./util.hpp"
+
+#include <stdexcept>
 
 namespace {
   constexpr char kOpeningBraceChar = '{';
@@ -12,21 +13,6 @@ namespace {
   constexpr char kCommaChar = ',';
   constexpr char kSemicolonChar = ';';
   constexpr char kDotOperatorChar = '.';
-  constexpr char kClassXMLTag[] = "class";
-  constexpr char kClassVarDeclXMLTag[] = "classVarDec";
-  constexpr char kSubroutineXMLTag[] = "subroutineDec";
-  constexpr char kParamListXMLTag[] = "parameterList";
-  constexpr char kSubroutineBodyXMLTag[] = "subroutineBody";
-  constexpr char kVarDeclXMLTag[] = "varDec";
-  constexpr char kStatementsXMLTag[] = "statements";
-  constexpr char kIfStatementXMLTag[] = "ifStatement";
-  constexpr char kWhileStatementXMLTag[] = "whileStatement";
-  constexpr char kDoStatementXMLTag[] = "doStatement";
-  constexpr char kReturnStatementXMLTag[] = "returnStatement";
-  constexpr char kLetStatementXMLTag[] = "LetStatement";
-  constexpr char kExpressionXMLTag[] = "expression";
-  constexpr char kExpressionListXMLTag[] = "expressionList";
-  constexpr char kTermXMLTag[] = "term";
 
   const std::set<char> kOperatorChars = {
     '+', '-', '*', '/', '&', '|', '<', '>', '='
@@ -156,255 +142,295 @@ namespace {
   }
 }
 
-std::vector<std::string> CompilationEngine::CompileClass() {
-  std::vector<std::string> xml;
-  xml.push_back(StartTag(kClassXMLTag));
-  xml.push_back(ConsumeKeyword({ Token::Keyword::CLASS }));
-  xml.push_back(ConsumeIdentifier());
-  xml.push_back(ConsumeSymbol({ kOpeningBraceChar }));
-  CompileClassVarDecls(&xml);
-  CompileSubroutineDecls(&xml);
-  xml.push_back(ConsumeSymbol({ kClosingBraceChar }));
-  xml.push_back(EndTag(kClassXMLTag));
-  return xml;
+const ClassNode* CompilationEngine::CompileClass() {
+  ClassNode* node = arena_.New<ClassNode>();
+  class_node_ = node;
+  ConsumeKeyword({ Token::Keyword::CLASS });
+  node->name = ConsumeIdentifier();
+  ConsumeSymbol({ kOpeningBraceChar });
+  node->var_decs = CompileClassVarDecls();
+  node->subroutines = CompileSubroutineDecls();
+  ConsumeSymbol({ kClosingBraceChar });
+  return node;
+}
+
+void CompilationEngine::ReplaceSubroutineBody(size_t index,
+                                              std::shared_ptr<const SourceBuffer> source,
+                                              const char* begin, const char* end) {
+  if (class_node_ == nullptr || index >= class_node_->subroutines.size()) {
+    throw std::out_of_range("No such subroutine");
+  }
+  sources_.push_back(tokenizer_.GetSource());
+  tokenizer_ = Tokenizer(source, begin, end);
+  SubroutineBodyNode* body = CompileSubroutineBody();
+  if (tokenizer_.HasNextToken()) {
+    throw std::runtime_error("Unexpected tokens after subroutine body!");
+  }
+  class_node_->subroutines[index]->body = body;
 }
 
-void CompilationEngine::CompileClassVarDecls(std::vector<std::string>* dest) {
+ArenaArray<VarDecNode*> CompilationEngine::CompileClassVarDecls() {
+  std::vector<VarDecNode*> var_decs;
   while (IsTokenStartOfClassVarDecl(tokenizer_.GetNextToken())) {
-    dest->push_back(StartTag(kClassVarDeclXMLTag));
-    dest->push_back(ConsumeKeyword(kPossibleClassVarDeclKeywords));
-    CompileType(dest);
-    dest->push_back(ConsumeIdentifier());
-    while (IsTokenComma(tokenizer_.GetNextToken())) {
-      dest->push_back(ConsumeSymbol({ kCommaChar }));
-      dest->push_back(ConsumeIdentifier());
-    }
-    dest->push_back(ConsumeSymbol({ kSemicolonChar }));
-    dest->push_back(EndTag(kClassVarDeclXMLTag));
+    var_decs.push_back(CompileVarDecl(kPossibleClassVarDeclKeywords));
   }
+  return arena_.NewArray(var_decs);
 }
 
-void CompilationEngine::CompileSubroutineDecls(std::vector<std::string>* dest) {
+ArenaArray<SubroutineDecNode*> CompilationEngine::CompileSubroutineDecls() {
+  std::vector<SubroutineDecNode*> subroutines;
   while (IsTokenStartOfSubroutineDecl(tokenizer_.GetNextToken())) {
-    dest->push_back(StartTag(kSubroutineXMLTag));
-    dest->push_back(ConsumeKeyword(kPossibleSubroutineKeywords));
+    SubroutineDecNode* node = arena_.New<SubroutineDecNode>();
+    node->keyword = ConsumeKeyword(kPossibleSubroutineKeywords);
 
     // (void | type)
     if (IsTokenAType(tokenizer_.GetNextToken())) {
-      CompileType(dest);
+      node->return_type = CompileType();
     } else {
-      dest->push_back(ConsumeKeyword({ Token::Keyword::VOID }));
+      node->return_type = ConsumeKeyword({ Token::Keyword::VOID });
     }
 
     // subroutineName
-    dest->push_back(ConsumeIdentifier());
+    node->name = ConsumeIdentifier();
 
-    dest->push_back(ConsumeSymbol({ kOpeningParenChar }));
-    CompileParamList(dest);
-    dest->push_back(ConsumeSymbol({ kClosingParenChar }));
-    CompileSubroutineBody(dest);
-    dest->push_back(EndTag(kSubroutineXMLTag));
+    ConsumeSymbol({ kOpeningParenChar });
+    node->parameters = CompileParamList();
+    ConsumeSymbol({ kClosingParenChar });
+    node->body = CompileSubroutineBody();
+    subroutines.push_back(node);
   }
+  return arena_.NewArray(subroutines);
 }
 
-void CompilationEngine::CompileParamList(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kParamListXMLTag));
+ArenaArray<ParameterNode> CompilationEngine::CompileParamList() {
+  std::vector<ParameterNode> parameters;
   while (IsTokenAType(tokenizer_.GetNextToken())) {
-    CompileType(dest);
-    dest->push_back(ConsumeIdentifier());
+    ParameterNode parameter;
+    parameter.type = CompileType();
+    parameter.name = ConsumeIdentifier();
+    parameters.push_back(parameter);
     if (IsTokenComma(tokenizer_.GetNextToken())) {
-      dest->push_back(ConsumeSymbol({ kCommaChar }));
+      ConsumeSymbol({ kCommaChar });
     }
   }
-  dest->push_back(EndTag(kParamListXMLTag));
+  return arena_.NewArray(parameters);
 }
 
-void CompilationEngine::CompileSubroutineBody(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kSubroutineBodyXMLTag));
-  dest->push_back(ConsumeSymbol({ kOpeningBraceChar }));
-  CompileVarDecls(dest);
-  CompileStatements(dest);
-  dest->push_back(ConsumeSymbol({ kClosingBraceChar }));
-  dest->push_back(EndTag(kSubroutineBodyXMLTag));
+SubroutineBodyNode* CompilationEngine::CompileSubroutineBody() {
+  SubroutineBodyNode* node = arena_.New<SubroutineBodyNode>();
+  CheckTokenizerHasNextToken();
+  const char* begin = tokenizer_.GetNextTokenStart();
+  ConsumeSymbol({ kOpeningBraceChar });
+  node->var_decs = CompileVarDecls();
+  node->statements = CompileStatements();
+  CheckTokenizerHasNextToken();
+  const char* closing_brace = tokenizer_.GetNextTokenStart();
+  ConsumeSymbol({ kClosingBraceChar });
+  node->source = std::string_view(begin, closing_brace + 1 - begin);
+  return node;
 }
 
-void CompilationEngine::CompileVarDecls(std::vector<std::string>* dest) {
+ArenaArray<VarDecNode*> CompilationEngine::CompileVarDecls() {
+  std::vector<VarDecNode*> var_decs;
   while (IsTokenStartOfVarDecl(tokenizer_.GetNextToken())) {
-    dest->push_back(StartTag(kVarDeclXMLTag));
-    dest->push_back(ConsumeKeyword({ Token::Keyword::VAR }));
-    CompileType(dest);
-    dest->push_back(ConsumeIdentifier());
-    while (IsTokenComma(tokenizer_.GetNextToken())) {
-      dest->push_back(ConsumeSymbol({ kCommaChar }));
-      dest->push_back(ConsumeIdentifier());
-    }
-    dest->push_back(ConsumeSymbol({ kSemicolonChar }));
-    dest->push_back(EndTag(kVarDeclXMLTag));
+    var_decs.push_back(CompileVarDecl({ Token::Keyword::VAR }));
   }
+  return arena_.NewArray(var_decs);
 }
 
-void CompilationEngine::CompileStatements(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kStatementsXMLTag));
+VarDecNode* CompilationEngine::CompileVarDecl(
+  const std::set<Token::Keyword>& possible_keywords) {
+  VarDecNode* node = arena_.New<VarDecNode>();
+  node->keyword = ConsumeKeyword(possible_keywords);
+  node->type = CompileType();
+  std::vector<Token> names = { ConsumeIdentifier() };
+  while (IsTokenComma(tokenizer_.GetNextToken())) {
+    ConsumeSymbol({ kCommaChar });
+    names.push_back(ConsumeIdentifier());
+  }
+  ConsumeSymbol({ kSemicolonChar });
+  node->names = arena_.NewArray(names);
+  return node;
+}
+
+ArenaArray<StatementNode*> CompilationEngine::CompileStatements() {
+  std::vector<StatementNode*> statements;
   while (IsTokenStartOfStatement(tokenizer_.GetNextToken())) {
     switch (tokenizer_.GetNextToken().GetKeyword()) {
       case Token::Keyword::IF:
-        CompileIfStatement(dest);
+        statements.push_back(CompileIfStatement());
         break;
       case Token::Keyword::WHILE:
-        CompileWhileStatement(dest);
+        statements.push_back(CompileWhileStatement());
         break;
       case Token::Keyword::LET:
-        CompileLetStatement(dest);
+        statements.push_back(CompileLetStatement());
         break;
       case Token::Keyword::DO:
-        CompileDoStatement(dest);
+        statements.push_back(CompileDoStatement());
         break;
       case Token::Keyword::RETURN:
-        CompileReturnStatement(dest);
+        statements.push_back(CompileReturnStatement());
     }
   }
-  dest->push_back(EndTag(kStatementsXMLTag));
+  return arena_.NewArray(statements);
 }
 
-void CompilationEngine::CompileIfStatement(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kIfStatementXMLTag));
-  dest->push_back(ConsumeKeyword({ Token::Keyword::IF }));
-  dest->push_back(ConsumeSymbol({ kOpeningParenChar }));
-  CompileExpression(dest);
-  dest->push_back(ConsumeSymbol({ kClosingParenChar }));
-  dest->push_back(ConsumeSymbol({ kOpeningBraceChar }));
-  CompileStatements(dest);
-  dest->push_back(ConsumeSymbol({ kClosingBraceChar }));
+StatementNode* CompilationEngine::CompileIfStatement() {
+  StatementNode* node = arena_.New<StatementNode>(StatementNode::StatementType::IF);
+  node->keyword = ConsumeKeyword({ Token::Keyword::IF });
+  ConsumeSymbol({ kOpeningParenChar });
+  node->expression = CompileExpression();
+  ConsumeSymbol({ kClosingParenChar });
+  ConsumeSymbol({ kOpeningBraceChar });
+  node->statements = CompileStatements();
+  ConsumeSymbol({ kClosingBraceChar });
   if (IsTokenElse(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeKeyword({ Token::Keyword::ELSE }));
-    dest->push_back(ConsumeSymbol({ kOpeningBraceChar }));
-    CompileStatements(dest);
-    dest->push_back(ConsumeSymbol({ kClosingBraceChar }));
+    ConsumeKeyword({ Token::Keyword::ELSE });
+    ConsumeSymbol({ kOpeningBraceChar });
+    node->has_else = true;
+    node->else_statements = CompileStatements();
+    ConsumeSymbol({ kClosingBraceChar });
   }
-  dest->push_back(EndTag(kIfStatementXMLTag));
+  return node;
 }
 
-void CompilationEngine::CompileWhileStatement(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kWhileStatementXMLTag));
-  dest->push_back(ConsumeKeyword({ Token::Keyword::WHILE }));
-  dest->push_back(ConsumeSymbol({ kOpeningParenChar }));
-  CompileExpression(dest);
-  dest->push_back(ConsumeSymbol({ kClosingParenChar }));
-  dest->push_back(ConsumeSymbol({ kOpeningBraceChar }));
-  CompileStatements(dest);
-  dest->push_back(ConsumeSymbol({ kClosingBraceChar }));
-  dest->push_back(EndTag(kWhileStatementXMLTag));
+StatementNode* CompilationEngine::CompileWhileStatement() {
+  StatementNode* node = arena_.New<StatementNode>(StatementNode::StatementType::WHILE);
+  node->keyword = ConsumeKeyword({ Token::Keyword::WHILE });
+  ConsumeSymbol({ kOpeningParenChar });
+  node->expression = CompileExpression();
+  ConsumeSymbol({ kClosingParenChar });
+  ConsumeSymbol({ kOpeningBraceChar });
+  node->statements = CompileStatements();
+  ConsumeSymbol({ kClosingBraceChar });
+  return node;
 }
 
-void CompilationEngine::CompileLetStatement(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kLetStatementXMLTag));
-  dest->push_back(ConsumeKeyword({ Token::Keyword::LET }));
-  dest->push_back(ConsumeIdentifier());
+StatementNode* CompilationEngine::CompileLetStatement() {
+  StatementNode* node = arena_.New<StatementNode>(StatementNode::StatementType::LET);
+  node->keyword = ConsumeKeyword({ Token::Keyword::LET });
+  node->var_name = ConsumeIdentifier();
   if (IsTokenOpeningBracket(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeSymbol({ kOpeningBracketChar }));
-    CompileExpression(dest);
-    dest->push_back(ConsumeSymbol({ kClosingBracketChar }));
-  }
-  dest->push_back(ConsumeSymbol({ kEqualsChar }));
-  CompileExpression(dest);
-  dest->push_back(ConsumeSymbol({ kSemicolonChar }));
-  dest->push_back(EndTag(kLetStatementXMLTag));
+    ConsumeSymbol({ kOpeningBracketChar });
+    node->index = CompileExpression();
+    ConsumeSymbol({ kClosingBracketChar });
+  }
+  ConsumeSymbol({ kEqualsChar });
+  node->expression = CompileExpression();
+  ConsumeSymbol({ kSemicolonChar });
+  return node;
 }
 
-void CompilationEngine::CompileDoStatement(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kDoStatementXMLTag));
-  dest->push_back(ConsumeKeyword({ Token::Keyword::DO }));
-  CompileSubroutineCall(dest, /*beginning_identifier_consumed=*/false);
-  dest->push_back(ConsumeSymbol({ kSemicolonChar }));
-  dest->push_back(EndTag(kDoStatementXMLTag));
+StatementNode* CompilationEngine::CompileDoStatement() {
+  StatementNode* node = arena_.New<StatementNode>(StatementNode::StatementType::DO);
+  node->keyword = ConsumeKeyword({ Token::Keyword::DO });
+  node->call = CompileSubroutineCall(ConsumeIdentifier());
+  ConsumeSymbol({ kSemicolonChar });
+  return node;
 }
 
-void CompilationEngine::CompileReturnStatement(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kReturnStatementXMLTag));
-  dest->push_back(ConsumeKeyword({ Token::Keyword::RETURN }));
+StatementNode* CompilationEngine::CompileReturnStatement() {
+  StatementNode* node = arena_.New<StatementNode>(StatementNode::StatementType::RETURN);
+  node->keyword = ConsumeKeyword({ Token::Keyword::RETURN });
   if (!IsTokenSemicolon(tokenizer_.GetNextToken())) {
-    CompileExpression(dest);
+    node->expression = CompileExpression();
   }
-  dest->push_back(ConsumeSymbol({ kSemicolonChar }));
-  dest->push_back(EndTag(kReturnStatementXMLTag));
+  ConsumeSymbol({ kSemicolonChar });
+  return node;
 }
 
-void CompilationEngine::CompileType(std::vector<std::string>* dest) {
+Token CompilationEngine::CompileType() {
   if (tokenizer_.GetNextToken().GetType() == Token::TokenType::KEYWORD) {
-    dest->push_back(ConsumeKeyword(kTypeKeywords));
-  } else {
-    dest->push_back(ConsumeIdentifier());
+    return ConsumeKeyword(kTypeKeywords);
   }
+  return ConsumeIdentifier();
 }
 
-void CompilationEngine::CompileExpression(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kExpressionXMLTag));
-  CompileTerm(dest);
+ExpressionNode* CompilationEngine::CompileExpression() {
+  ExpressionNode* node = arena_.New<ExpressionNode>();
+  node->first = CompileTerm();
+  std::vector<OperationNode> operations;
   while (IsTokenOperator(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeSymbol({ kOperatorChars }));
-    CompileTerm(dest);
+    OperationNode operation;
+    operation.op = ConsumeSymbol(kOperatorChars);
+    operation.term = CompileTerm();
+    operations.push_back(operation);
   }
-  dest->push_back(EndTag(kExpressionXMLTag));
+  node->operations = arena_.NewArray(operations);
+  return node;
 }
 
-void CompilationEngine::CompileTerm(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kTermXMLTag));
-  if (IsIntegerConstant(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeConstInt());
-  } else if (IsStringConstant(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeConstString());
-  } else if (IsKeywordConstant(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeKeyword(kKeywordConstants));
-  } else if (IsUnaryOp(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeSymbol(kUnaryOperatorChars));
-    CompileTerm(dest);
-  } else if (IsOpeningParen(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeSymbol({ kOpeningParenChar }));
-    CompileExpression(dest);
-    dest->push_back(ConsumeSymbol({ kClosingParenChar }));
+TermNode* CompilationEngine::CompileTerm() {
+  const Token& next_token = tokenizer_.GetNextToken();
+  TermNode* node;
+  if (IsIntegerConstant(next_token)) {
+    node = arena_.New<TermNode>(TermNode::TermType::INT_CONSTANT);
+    node->token = ConsumeConstInt();
+  } else if (IsStringConstant(next_token)) {
+    node = arena_.New<TermNode>(TermNode::TermType::STRING_CONSTANT);
+    node->token = ConsumeConstString();
+  } else if (IsKeywordConstant(next_token)) {
+    node = arena_.New<TermNode>(TermNode::TermType::KEYWORD_CONSTANT);
+    node->token = ConsumeKeyword(kKeywordConstants);
+  } else if (IsUnaryOp(next_token)) {
+    node = arena_.New<TermNode>(TermNode::TermType::UNARY_OP);
+    node->token = ConsumeSymbol(kUnaryOperatorChars);
+    node->operand = CompileTerm();
+  } else if (IsOpeningParen(next_token)) {
+    node = arena_.New<TermNode>(TermNode::TermType::PARENTHESIZED);
+    ConsumeSymbol({ kOpeningParenChar });
+    node->expression = CompileExpression();
+    ConsumeSymbol({ kClosingParenChar });
   } else {
-    dest->push_back(ConsumeIdentifier());
+    Token identifier = ConsumeIdentifier();
 
     if (IsOpeningParen(tokenizer_.GetNextToken()) || IsDotOperator(tokenizer_.GetNextToken())) {
-      CompileSubroutineCall(dest, /*beginning_identifier_consumed=*/true);
+      node = arena_.New<TermNode>(TermNode::TermType::SUBROUTINE_CALL);
+      node->call = CompileSubroutineCall(identifier);
     } else if (IsTokenOpeningBracket(tokenizer_.GetNextToken())) {
-      dest->push_back(ConsumeSymbol({ kOpeningBracketChar }));
-      CompileExpression(dest);
-      dest->push_back(ConsumeSymbol({ kClosingBracketChar }));
+      node = arena_.New<TermNode>(TermNode::TermType::ARRAY_ELEMENT);
+      node->token = identifier;
+      ConsumeSymbol({ kOpeningBracketChar });
+      node->expression = CompileExpression();
+      ConsumeSymbol({ kClosingBracketChar });
+    } else {
+      node = arena_.New<TermNode>(TermNode::TermType::VARIABLE);
+      node->token = identifier;
     }
   }
-  dest->push_back(EndTag(kTermXMLTag));
+  return node;
 }
 
-void CompilationEngine::CompileSubroutineCall(std::vector<std::string>* dest,
-                                              bool beginning_identifier_consumed) {
-  if (!beginning_identifier_consumed) {
-    dest->push_back(ConsumeIdentifier());
-  }
-
+SubroutineCallNode* CompilationEngine::CompileSubroutineCall(const Token& identifier) {
+  SubroutineCallNode* node = arena_.New<SubroutineCallNode>();
   if (IsDotOperator(tokenizer_.GetNextToken())) {
-    dest->push_back(ConsumeSymbol({ kDotOperatorChar }));
-    dest->push_back(ConsumeIdentifier());
+    ConsumeSymbol({ kDotOperatorChar });
+    node->has_receiver = true;
+    node->receiver = identifier;
+    node->name = ConsumeIdentifier();
+  } else {
+    node->name = identifier;
   }
-  dest->push_back(ConsumeSymbol({ kOpeningParenChar }));
-  CompileExpressionList(dest);
-  dest->push_back(ConsumeSymbol({ kClosingParenChar }));
+  ConsumeSymbol({ kOpeningParenChar });
+  node->arguments = CompileExpressionList();
+  ConsumeSymbol({ kClosingParenChar });
+  return node;
 }
 
-void CompilationEngine::CompileExpressionList(std::vector<std::string>* dest) {
-  dest->push_back(StartTag(kExpressionListXMLTag));
+ArenaArray<ExpressionNode*> CompilationEngine::CompileExpressionList() {
+  std::vector<ExpressionNode*> expressions;
   if (!IsClosingParen(tokenizer_.GetNextToken())) {
-    CompileExpression(dest);
+    expressions.push_back(CompileExpression());
     while (IsTokenComma(tokenizer_.GetNextToken())) {
-      dest->push_back(ConsumeSymbol({ kCommaChar }));
-      CompileExpression(dest);
+      ConsumeSymbol({ kCommaChar });
+      expressions.push_back(CompileExpression());
     }
   }
-  dest->push_back(EndTag(kExpressionListXMLTag));
+  return arena_.NewArray(expressions);
 }
 
-std::string
-CompilationEngine::ConsumeKeyword(
+Token CompilationEngine::ConsumeKeyword(
   const std::set<Token::Keyword>& possible_keywords) {
   CheckTokenizerHasNextToken();
   Token token = tokenizer_.GetNextToken();
@@ -416,20 +442,20 @@ CompilationEngine::ConsumeKeyword(
   }
 
   tokenizer_.Advance();
-  return token.ToXML();
+  return token;
 }
 
-std::string CompilationEngine::ConsumeIdentifier() {
+Token CompilationEngine::ConsumeIdentifier() {
   CheckTokenizerHasNextToken();
   Token token = tokenizer_.GetNextToken();
   if (token.GetType() != Token::TokenType::IDENTIFIER) {
     throw std::runtime_error("Expected identifier token!");
   }
   tokenizer_.Advance();
-  return token.ToXML();
+  return token;
 }
 
-std::string CompilationEngine::ConsumeSymbol(const std::set<char>& possible_symbols) {
+Token CompilationEngine::ConsumeSymbol(const std::set<char>& possible_symbols) {
   CheckTokenizerHasNextToken();
   Token token = tokenizer_.GetNextToken();
   if (token.GetType() != Token::TokenType::SYMBOL) {
@@ -439,27 +465,27 @@ std::string CompilationEngine::ConsumeSymbol(const std::set<char>& possible_symb
     throw std::runtime_error("Wrong symbol token found!");
   }
   tokenizer_.Advance();
-  return token.ToXML();
+  return token;
 }
 
-std::string CompilationEngine::ConsumeConstInt() {
+Token CompilationEngine::ConsumeConstInt() {
   CheckTokenizerHasNextToken();
   Token token = tokenizer_.GetNextToken();
   if (token.GetType() != Token::TokenType::CONST_INT) {
     throw std::runtime_error("Expected const int token!");
   }
   tokenizer_.Advance();
-  return token.ToXML();
+  return token;
 }
 
-std::string CompilationEngine::ConsumeConstString() {
+Token CompilationEngine::ConsumeConstString() {
   CheckTokenizerHasNextToken();
   Token token = tokenizer_.GetNextToken();
   if (token.GetType() != Token::TokenType::CONST_STRING) {
     throw std::runtime_error("Expected const string token!");
   }
   tokenizer_.Advance();
-  return token.ToXML();
+  return token;
 }
 
 void CompilationEngine::CheckTokenizerHasNextToken() const {
@@ -1,45 +1,67 @@
 #ifndef SYNTAX_ANALYZER_COMPILATION_ENGINE_HPP_
 #define SYNTAX_ANALYZER_COMPILATION_ENGINE_HPP_
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "./arena.hpp"
+#include "./ast.hpp"
+#include "./source-buffer.hpp"
 #include "./token.hpp"
 #include "./tokenizer.hpp"
 
+// Recursive-descent parser for one Jack class. The syntax tree is
+// allocated in the engine's arena and points into its source buffers, so
+// it stays valid for as long as the engine does.
 class CompilationEngine {
  public:
-  CompilationEngine(const std::string& filename) : tokenizer_(filename) {}
-  std::vector<std::string> CompileClass();
+  CompilationEngine(const std::string& filename) : tokenizer_(filename),
+    class_node_(nullptr) {}
+  explicit CompilationEngine(std::shared_ptr<const SourceBuffer> source) :
+    tokenizer_(source), class_node_(nullptr) {}
+  const ClassNode* CompileClass();
+
+  // Re-parses the body of the |index|th subroutine of the class from
+  // [begin, end) of |source|, which must hold exactly one subroutine body,
+  // braces included, and swaps it into the tree returned by CompileClass().
+  // The rest of the tree is untouched. Throws on syntax errors, in which
+  // case the tree keeps the old body.
+  void ReplaceSubroutineBody(size_t index,
+                             std::shared_ptr<const SourceBuffer> source,
+                             const char* begin, const char* end);
 
  private:
-   void CompileTerm(std::vector<std::string>*dest);
-   void CompileExpressionList(std::vector<std::string>* dest);
-   void CompileExpression(std::vector<std::string>* dest);
-   void CompileSubroutineCall(std::vector<std::string>* dest,
-                              bool beginning_identifier_consumed);
-   void CompileIfStatement(std::vector<std::string>* dest);
-   void CompileWhileStatement(std::vector<std::string>* dest);
-   void CompileLetStatement(std::vector<std::string>* dest);
-   void CompileDoStatement(std::vector<std::string>* dest);
-   void CompileReturnStatement(std::vector<std::string>* dest);
-   void CompileStatements(std::vector<std::string>*dest);
-   void CompileVarDecls(std::vector<std::string>* dest);
-   void CompileClassVarDecls(std::vector<std::string>* dest);
-   void CompileSubroutineDecls(std::vector<std::string>* dest);
-   void CompileSubroutineBody(std::vector<std::string>* dest);
-   void CompileParamList(std::vector<std::string>* dest);
-   void CompileType(std::vector<std::string>* dest);
+   TermNode* CompileTerm();
+   ArenaArray<ExpressionNode*> CompileExpressionList();
+   ExpressionNode* CompileExpression();
+   SubroutineCallNode* CompileSubroutineCall(const Token& identifier);
+   StatementNode* CompileIfStatement();
+   StatementNode* CompileWhileStatement();
+   StatementNode* CompileLetStatement();
+   StatementNode* CompileDoStatement();
+   StatementNode* CompileReturnStatement();
+   ArenaArray<StatementNode*> CompileStatements();
+   ArenaArray<VarDecNode*> CompileVarDecls();
+   VarDecNode* CompileVarDecl(const std::set<Token::Keyword>& possible_keywords);
+   ArenaArray<VarDecNode*> CompileClassVarDecls();
+   ArenaArray<SubroutineDecNode*> CompileSubroutineDecls();
+   SubroutineBodyNode* CompileSubroutineBody();
+   ArenaArray<ParameterNode> CompileParamList();
+   Token CompileType();
 
-   std::string ConsumeKeyword(
-     const std::set<Token::Keyword>& possible_keywords);
-   std::string ConsumeIdentifier();
-   std::string ConsumeSymbol(const std::set<char>& possible_symbols);
-   std::string ConsumeConstString();
-   std::string ConsumeConstInt();
+   Token ConsumeKeyword(const std::set<Token::Keyword>& possible_keywords);
+   Token ConsumeIdentifier();
+   Token ConsumeSymbol(const std::set<char>& possible_symbols);
+   Token ConsumeConstString();
+   Token ConsumeConstInt();
    void CheckTokenizerHasNextToken() const;
    Tokenizer tokenizer_;
+   // Earlier buffers that parts of the tree still point into.
+   std::vector<std::shared_ptr<const SourceBuffer>> sources_;
+   Arena arena_;
+   ClassNode* class_node_;
 };
 
 #endif
@@ -0,0 +1,277 @@
+#include "./compile-daemon.hpp"
+#include "./work-stealing-pool.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <exception>
+#include <set>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+
+namespace {
+  constexpr char kJackExtension[] = ".jack";
+  constexpr char kBuildCommand[] = "build";
+  constexpr char kQuitCommand[] = "quit";
+
+  constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+  constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+  constexpr int64_t kNanosecondsPerSecond = 1000000000;
+
+  int64_t GetModificationTime(const struct stat& file_stat) {
+    return static_cast<int64_t>(file_stat.st_mtim.tv_sec) * kNanosecondsPerSecond +
+           file_stat.st_mtim.tv_nsec;
+  }
+
+  // A full parse every so often drops the old buffers that re-parsed
+  // classes keep alive and refreshes their line numbers.
+  constexpr size_t kMaxIncrementalEdits = 16;
+
+  // 64-bit FNV-1a hash of |source|.
+  uint64_t HashContents(const SourceBuffer& source) {
+    uint64_t hash = kFnvOffsetBasis;
+    for (const char* c = source.begin(); c != source.end(); c++) {
+      hash = (hash ^ static_cast<unsigned char>(*c)) * kFnvPrime;
+    }
+    return hash;
+  }
+}
+
+CompileDaemon::CompileDaemon(const std::string& directory,
+                             const CompilerOptions& options)
+  : directory_(directory), options_(options) {}
+
+CompileDaemon::BuildResult CompileDaemon::Build() {
+  BuildResult result;
+  std::set<std::string> present;
+  struct Change {
+    std::string file_in;
+    std::shared_ptr<const SourceBuffer> source;
+    CachedClass* cached_class;
+  };
+  std::vector<Change> changed;
+
+  for (const auto& entry : boost::filesystem::directory_iterator(directory_)) {
+    if (entry.path().extension() != kJackExtension) {
+      continue;
+    }
+    std::string file_in = entry.path().string();
+    present.insert(file_in);
+
+    struct stat file_stat;
+    if (stat(file_in.c_str(), &file_stat) < 0) {
+      throw std::runtime_error("Cannot stat " + file_in);
+    }
+    uintmax_t size = file_stat.st_size;
+    int64_t last_write_time = GetModificationTime(file_stat);
+
+    bool is_new = classes_.find(file_in) == classes_.end();
+    CachedClass& cached_class = classes_[file_in];
+    if (!is_new && size == cached_class.size &&
+        last_write_time == cached_class.last_write_time) {
+      result.unchanged++;
+      continue;
+    }
+    cached_class.size = size;
+    cached_class.last_write_time = last_write_time;
+
+    // Touched but not edited, e.g. by a checkout: nothing to redo.
+    auto source = std::make_shared<const SourceBuffer>(file_in, SourceBuffer::Mode::COPY);
+    uint64_t content_hash = HashContents(*source);
+    if (!is_new && content_hash == cached_class.content_hash) {
+      result.unchanged++;
+      continue;
+    }
+    cached_class.content_hash = content_hash;
+    changed.push_back({ file_in, source, &cached_class });
+  }
+
+  for (auto it = classes_.begin(); it != classes_.end();) {
+    if (present.find(it->first) == present.end()) {
+      it = classes_.erase(it);
+      result.removed++;
+    } else {
+      it++;
+    }
+  }
+
+  size_t num_threads = options_.num_threads != 0 ?
+    options_.num_threads : std::thread::hardware_concurrency();
+  if (!changed.empty()) {
+    WorkStealingPool pool(std::max<size_t>(1, std::min(num_threads, changed.size())));
+    for (const auto& change : changed) {
+      pool.Submit([this, &change] { Parse(change.source, change.cached_class); });
+    }
+    pool.Wait();
+  }
+  result.compiled = changed.size();
+  for (const auto& change : changed) {
+    if (change.cached_class->was_reparsed) {
+      result.reparsed++;
+    }
+  }
+
+  std::vector<std::pair<std::string, CachedClass*>> to_generate;
+  bool interfaces_changed = false;
+  if (options_.emit_vm) {
+    ClassInterfaces interfaces;
+    for (const auto& cached_class : classes_) {
+      if (cached_class.second.parsed_class != nullptr) {
+        interfaces.Add(ClassInterface::FromClass(*cached_class.second.parsed_class));
+      }
+    }
+    interfaces_changed = !(interfaces == interfaces_);
+    interfaces_ = std::move(interfaces);
+  }
+  if (interfaces_changed) {
+    for (auto& cached_class : classes_) {
+      to_generate.emplace_back(cached_class.first, &cached_class.second);
+    }
+  } else {
+    for (const auto& change : changed) {
+      to_generate.emplace_back(change.file_in, change.cached_class);
+    }
+  }
+  if (!to_generate.empty()) {
+    WorkStealingPool pool(std::max<size_t>(1, std::min(num_threads, to_generate.size())));
+    for (const auto& entry : to_generate) {
+      pool.Submit([this, &entry] { Generate(entry.first, entry.second); });
+    }
+    pool.Wait();
+  }
+
+  for (const auto& cached_class : classes_) {
+    if (!cached_class.second.error.empty()) {
+      result.errors.push_back(cached_class.first + ": " + cached_class.second.error);
+    }
+  }
+  return result;
+}
+
+void CompileDaemon::Parse(std::shared_ptr<const SourceBuffer> source,
+                          CachedClass* cached_class) const {
+  cached_class->error.clear();
+  cached_class->was_reparsed = TryReparseSubroutine(source, cached_class);
+  if (cached_class->was_reparsed) {
+    return;
+  }
+  try {
+    ParseClass(source, cached_class);
+  } catch (const std::exception& e) {
+    cached_class->error = e.what();
+  }
+}
+
+void CompileDaemon::Generate(const std::string& file_in, CachedClass* cached_class) const {
+  if (cached_class->parsed_class == nullptr) {
+    // Keeps the parse error.
+    return;
+  }
+  cached_class->error.clear();
+  try {
+    WriteClass(*cached_class->parsed_class, GetOutputPath(file_in, options_), options_,
+               &interfaces_);
+  } catch (const std::exception& e) {
+    cached_class->error = e.what();
+  }
+}
+
+void CompileDaemon::ParseClass(std::shared_ptr<const SourceBuffer> source,
+                               CachedClass* cached_class) const {
+  cached_class->engine.reset();
+  cached_class->parsed_class = nullptr;
+  cached_class->source.reset();
+
+  std::unique_ptr<CompilationEngine> engine(new CompilationEngine(source));
+  const ClassNode* parsed_class = engine->CompileClass();
+  cached_class->body_offsets.clear();
+  for (const SubroutineDecNode* subroutine : parsed_class->subroutines) {
+    cached_class->body_offsets.push_back(
+      subroutine->body->source.data() - source->begin());
+  }
+  cached_class->engine = std::move(engine);
+  cached_class->parsed_class = parsed_class;
+  cached_class->source = source;
+  cached_class->incremental_edits = 0;
+}
+
+bool CompileDaemon::TryReparseSubroutine(std::shared_ptr<const SourceBuffer> source,
+                                         CachedClass* cached_class) const {
+  if (cached_class->engine == nullptr ||
+      cached_class->incremental_edits >= kMaxIncrementalEdits) {
+    return false;
+  }
+
+  // The edit is whatever lies between the longest common prefix and the
+  // longest common suffix of the old and new contents.
+  const SourceBuffer& old_source = *cached_class->source;
+  size_t prefix = std::mismatch(old_source.begin(), old_source.end(),
+                                source->begin(), source->end()).first - old_source.begin();
+  size_t max_suffix = std::min(old_source.size(), source->size()) - prefix;
+  size_t suffix = 0;
+  while (suffix < max_suffix &&
+         old_source.end()[-1 - static_cast<ptrdiff_t>(suffix)] ==
+         source->end()[-1 - static_cast<ptrdiff_t>(suffix)]) {
+    suffix++;
+  }
+  size_t edit_end = old_source.size() - suffix;
+  ptrdiff_t growth = static_cast<ptrdiff_t>(source->size()) -
+                     static_cast<ptrdiff_t>(old_source.size());
+
+  const auto& subroutines = cached_class->parsed_class->subroutines;
+  for (size_t i = 0; i < subroutines.size(); i++) {
+    size_t body_begin = cached_class->body_offsets[i];
+    size_t body_end = body_begin + subroutines[i]->body->source.size();
+    // Both braces must survive the edit.
+    if (prefix <= body_begin || edit_end >= body_end) {
+      continue;
+    }
+    try {
+      cached_class->engine->ReplaceSubroutineBody(
+        i, source, source->begin() + body_begin, source->begin() + body_end + growth);
+    } catch (const std::exception&) {
+      // E.g. the edit moved the closing brace; a full parse sorts it out.
+      return false;
+    }
+    for (size_t j = i + 1; j < subroutines.size(); j++) {
+      cached_class->body_offsets[j] += growth;
+    }
+    cached_class->source = source;
+    cached_class->incremental_edits++;
+    return true;
+  }
+  return false;
+}
+
+void CompileDaemon::Serve(std::istream& in, std::ostream& out) {
+  std::string command;
+  while (std::getline(in, command)) {
+    if (command == kQuitCommand) {
+      return;
+    }
+    if (command != kBuildCommand) {
+      out << "error unknown command: " << command << "\nend" << std::endl;
+      continue;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BuildResult result;
+    try {
+      result = Build();
+    } catch (const std::exception& e) {
+      result.errors.push_back(directory_ + ": " + e.what());
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+    out << "ok " << result.compiled << ' ' << result.reparsed << ' '
+        << result.unchanged << ' ' << result.removed << ' ' << elapsed.count() << '\n';
+    for (const auto& error : result.errors) {
+      out << "error " << error << '\n';
+    }
+    // A build tool waits for this line, so flush it now.
+    out << "end" << std::endl;
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef SYNTAX_ANALYZER_COMPILE_DAEMON_HPP_
+#define SYNTAX_ANALYZER_COMPILE_DAEMON_HPP_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "./ast.hpp"
+#include "./class-interface.hpp"
+#include "./compilation-engine.hpp"
+#include "./jack-compiler.hpp"
+#include "./source-buffer.hpp"
+
+// Long-running compiler for one project directory. Parsed classes are kept
+// in memory between builds, and a build only recompiles the classes whose
+// contents changed since the previous one. When all edits to a class fall
+// inside one subroutine body, only that body is re-lexed and re-parsed and
+// the rest of the class's tree is reused; line numbers in error messages
+// about later subroutines may then be off until the class is next parsed
+// in full.
+//
+// Calls between the directory's classes are checked against each other's
+// interfaces, so when a build changes a class's interface every class is
+// compiled again, from the trees already in memory.
+//
+// Build tools talk to the daemon through Serve(), one command per line:
+//
+//   build   Rescans the directory and recompiles changed classes. Answers
+//           "ok <compiled> <reparsed> <unchanged> <removed> <microseconds>",
+//           where <reparsed> counts the compiled classes that only needed
+//           one subroutine body re-parsed, then one "error <file>:
+//           <message>" line per class that does not compile, then "end".
+//   quit    Stops serving.
+class CompileDaemon {
+ public:
+  struct BuildResult {
+    size_t compiled = 0;
+    size_t reparsed = 0;
+    size_t unchanged = 0;
+    size_t removed = 0;
+    // One message per class that failed, ordered by file path.
+    std::vector<std::string> errors;
+  };
+
+  CompileDaemon(const std::string& directory, const CompilerOptions& options);
+
+  BuildResult Build();
+  // Answers commands read from |in| on |out| until "quit" or end of input.
+  void Serve(std::istream& in, std::ostream& out);
+
+ private:
+  struct CachedClass {
+    // Cheap change check: a class whose size and modification time are
+    // unchanged is not rehashed.
+    uintmax_t size = 0;
+    // Nanoseconds since the epoch.
+    int64_t last_write_time = 0;
+    uint64_t content_hash = 0;
+    // The contents |parsed_class| currently describes.
+    std::shared_ptr<const SourceBuffer> source;
+    // Owns the tokenizer and arena that |parsed_class| lives in. Null if
+    // the class failed to parse.
+    std::unique_ptr<CompilationEngine> engine;
+    const ClassNode* parsed_class = nullptr;
+    // Offset in |source| of each subroutine body's opening brace.
+    std::vector<size_t> body_offsets;
+    // Bodies re-parsed since the last full parse.
+    size_t incremental_edits = 0;
+    bool was_reparsed = false;
+    std::string error;
+  };
+
+  void Parse(std::shared_ptr<const SourceBuffer> source,
+             CachedClass* cached_class) const;
+  void Generate(const std::string& file_in, CachedClass* cached_class) const;
+  void ParseClass(std::shared_ptr<const SourceBuffer> source,
+                  CachedClass* cached_class) const;
+  bool TryReparseSubroutine(std::shared_ptr<const SourceBuffer> source,
+                            CachedClass* cached_class) const;
+
+  std::string directory_;
+  CompilerOptions options_;
+  ClassInterfaces interfaces_;
+  // Keyed by source path.
+  std::map<std::string, CachedClass> classes_;
+};
+
+#endif
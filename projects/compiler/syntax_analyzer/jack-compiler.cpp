@@ -0,0 +1,258 @@
+#include "./jack-compiler.hpp"
+#include "./code-generator.hpp"
+#include "./compilation-engine.hpp"
+#include "./program-optimizer.hpp"
+#include "./vm-writer.hpp"
+#include "./work-stealing-pool.hpp"
+#include "./xml-printer.hpp"
+#include "./xml-writer.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+  constexpr char kJackExtension[] = ".jack";
+  constexpr char kVMExtension[] = ".vm";
+  constexpr char kXMLExtension[] = ".xml";
+  // Statics live in RAM[16..255].
+  constexpr int kMaxStatics = 240;
+
+  struct Source {
+    boost::filesystem::path path;
+    uintmax_t size;
+  };
+
+  std::vector<Source> FindSources(const std::vector<std::string>& paths) {
+    std::vector<Source> sources;
+    for (const auto& path : paths) {
+      if (boost::filesystem::is_directory(path)) {
+        for (const auto& entry : boost::filesystem::directory_iterator(path)) {
+          if (entry.path().extension() == kJackExtension) {
+            sources.push_back({ entry.path(), boost::filesystem::file_size(entry.path()) });
+          }
+        }
+      } else {
+        // A missing file gets size 0 here and fails to open when compiled.
+        boost::system::error_code error;
+        uintmax_t size = boost::filesystem::file_size(path, error);
+        sources.push_back({ path, error ? 0 : size });
+      }
+    }
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) {
+      return a.path < b.path;
+    });
+    return sources;
+  }
+
+  // Largest classes first, so that a big class picked up last does not
+  // leave the other workers idle at the end.
+  std::vector<size_t> GetLargestFirstOrder(const std::vector<Source>& sources) {
+    std::vector<size_t> order(sources.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sources](size_t a, size_t b) {
+      return sources[a].size > sources[b].size;
+    });
+    return order;
+  }
+
+  size_t GetThreadCount(const CompilerOptions& options, size_t num_sources) {
+    size_t num_threads = options.num_threads != 0 ?
+      options.num_threads : std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min(num_threads, num_sources));
+  }
+
+  struct ParsedSources {
+    // Own the trees in |classes|.
+    std::vector<std::unique_ptr<CompilationEngine>> engines;
+    // Null where the source failed to parse.
+    std::vector<const ClassNode*> classes;
+  };
+
+  ParsedSources ParseSources(const std::vector<Source>& sources,
+                             const std::vector<size_t>& order,
+                             WorkStealingPool* pool,
+                             std::vector<std::string>* errors) {
+    ParsedSources parsed;
+    parsed.engines.resize(sources.size());
+    parsed.classes.resize(sources.size(), nullptr);
+    for (size_t i : order) {
+      pool->Submit([&sources, &parsed, errors, i] {
+        const std::string file_in = sources[i].path.string();
+        try {
+          parsed.engines[i].reset(new CompilationEngine(file_in));
+          parsed.classes[i] = parsed.engines[i]->CompileClass();
+        } catch (const std::exception& e) {
+          (*errors)[i] = file_in + ": " + e.what();
+        }
+      });
+    }
+    pool->Wait();
+    return parsed;
+  }
+
+  // Drops the empty messages of the classes that compiled.
+  std::vector<std::string> CollectErrors(std::vector<std::string>* errors) {
+    errors->erase(std::remove(errors->begin(), errors->end(), std::string()),
+                  errors->end());
+    return std::move(*errors);
+  }
+
+  std::string GetDirectory(const std::string& filename) {
+    boost::filesystem::path directory = boost::filesystem::path(filename).parent_path();
+    return directory.empty() ? "." : directory.string();
+  }
+}
+
+void CompileFile(const std::string& file_in,
+                 const std::string& file_out,
+                 const CompilerOptions& options) {
+  CompilationEngine engine(file_in);
+  const ClassNode* parsed_class = engine.CompileClass();
+  // The interface files of other classes are read from where this one's
+  // is written, next to |file_out|.
+  ClassInterfaces interfaces;
+  if (options.emit_vm) {
+    interfaces.LoadDirectory(GetDirectory(file_out));
+  }
+  WriteClass(*parsed_class, file_out, options, &interfaces);
+}
+
+void WriteClass(const ClassNode& parsed_class,
+                const std::string& file_out,
+                const CompilerOptions& options,
+                const ClassInterfaces* interfaces) {
+  std::ofstream out(file_out);
+  if (!out) {
+    throw std::runtime_error("Cannot write " + file_out);
+  }
+  if (options.emit_vm) {
+    VMWriter writer(out);
+    CodeGenerator(&writer, interfaces).CompileClass(parsed_class);
+    std::string interface_out = GetInterfacePath(file_out);
+    std::ofstream interface_file(interface_out, std::ios::binary);
+    if (!interface_file) {
+      throw std::runtime_error("Cannot write " + interface_out);
+    }
+    WriteClassInterface(ClassInterface::FromClass(parsed_class), interface_file);
+  } else {
+    XMLWriter writer(out);
+    XMLPrinter(&writer).PrintClass(parsed_class);
+  }
+}
+
+std::string GetOutputPath(const std::string& file_in, const CompilerOptions& options) {
+  boost::filesystem::path out(file_in);
+  out.replace_extension(options.emit_vm ? kVMExtension : kXMLExtension);
+  return out.string();
+}
+
+std::vector<std::string> CompileSources(const std::vector<std::string>& paths,
+                                        const CompilerOptions& options) {
+  std::vector<Source> sources = FindSources(paths);
+  std::vector<std::string> errors(sources.size());
+  std::vector<size_t> order = GetLargestFirstOrder(sources);
+  WorkStealingPool pool(GetThreadCount(options, sources.size()));
+
+  if (!options.emit_vm) {
+    for (size_t i : order) {
+      pool.Submit([&sources, &errors, &options, i] {
+        const std::string file_in = sources[i].path.string();
+        try {
+          CompileFile(file_in, GetOutputPath(file_in, options), options);
+        } catch (const std::exception& e) {
+          errors[i] = file_in + ": " + e.what();
+        }
+      });
+    }
+    pool.Wait();
+    return CollectErrors(&errors);
+  }
+
+  // Interface files next to the sources stand in for classes that are
+  // not part of this build; the classes that are come from their trees.
+  ClassInterfaces interfaces;
+  std::set<std::string> directories;
+  for (const Source& source : sources) {
+    directories.insert(GetDirectory(source.path.string()));
+  }
+  for (const auto& directory : directories) {
+    interfaces.LoadDirectory(directory);
+  }
+
+  ParsedSources parsed = ParseSources(sources, order, &pool, &errors);
+  for (const ClassNode* parsed_class : parsed.classes) {
+    if (parsed_class != nullptr) {
+      interfaces.Add(ClassInterface::FromClass(*parsed_class));
+    }
+  }
+  for (size_t i : order) {
+    if (parsed.classes[i] == nullptr) {
+      continue;
+    }
+    pool.Submit([&sources, &errors, &parsed, &interfaces, &options, i] {
+      const std::string file_in = sources[i].path.string();
+      try {
+        WriteClass(*parsed.classes[i], GetOutputPath(file_in, options), options,
+                   &interfaces);
+      } catch (const std::exception& e) {
+        errors[i] = file_in + ": " + e.what();
+      }
+    });
+  }
+  pool.Wait();
+  return CollectErrors(&errors);
+}
+
+std::vector<std::string> CompileProgram(const std::vector<std::string>& paths,
+                                        const std::string& file_out,
+                                        const CompilerOptions& options) {
+  std::vector<Source> sources = FindSources(paths);
+  std::vector<std::string> errors(sources.size());
+  ParsedSources parsed;
+  {
+    WorkStealingPool pool(GetThreadCount(options, sources.size()));
+    parsed = ParseSources(sources, GetLargestFirstOrder(sources), &pool, &errors);
+  }
+  errors = CollectErrors(&errors);
+  if (!errors.empty()) {
+    return errors;
+  }
+
+  ClassInterfaces interfaces;
+  for (const ClassNode* parsed_class : parsed.classes) {
+    interfaces.Add(ClassInterface::FromClass(*parsed_class));
+  }
+  ProgramOptimizer program(parsed.classes);
+
+  std::ofstream out(file_out);
+  if (!out) {
+    return { "Cannot write " + file_out };
+  }
+  // Classes are written one after the other, in path order, each with its
+  // statics numbered after the previous ones'.
+  VMWriter writer(out);
+  int static_count = 0;
+  for (size_t i = 0; i < sources.size(); i++) {
+    try {
+      CodeGenerator generator(&writer, &interfaces, &program);
+      generator.CompileClass(*parsed.classes[i], static_count);
+      static_count += generator.GetStaticCount();
+    } catch (const std::exception& e) {
+      errors.push_back(sources[i].path.string() + ": " + e.what());
+    }
+  }
+  if (static_count > kMaxStatics) {
+    errors.push_back(file_out + ": " + std::to_string(static_count) +
+                     " statics, but the VM has room for " + std::to_string(kMaxStatics));
+  }
+  return errors;
+}
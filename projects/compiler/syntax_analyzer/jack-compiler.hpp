@@ -0,0 +1,54 @@
+#ifndef SYNTAX_ANALYZER_JACK_COMPILER_HPP_
+#define SYNTAX_ANALYZER_JACK_COMPILER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "./ast.hpp"
+#include "./class-interface.hpp"
+
+struct CompilerOptions {
+  // Writes VM code instead of the XML parse tree.
+  bool emit_vm = false;
+  // Worker threads used by CompileSources; 0 means one per hardware thread.
+  size_t num_threads = 0;
+};
+
+// Compiles the Jack class in |file_in| to |file_out|. Calls into other
+// classes are checked against the OS and the interface files next to
+// |file_out|, where the class's own interface file goes. Throws on errors.
+void CompileFile(const std::string& file_in,
+                 const std::string& file_out,
+                 const CompilerOptions& options);
+
+// Writes the VM code or XML for an already parsed class to |file_out|.
+// VM code is checked against |interfaces| and comes with an interface
+// file, Foo.jci next to Foo.vm, for compiling the class's callers.
+void WriteClass(const ClassNode& parsed_class,
+                const std::string& file_out,
+                const CompilerOptions& options,
+                const ClassInterfaces* interfaces = nullptr);
+
+// Foo.jack -> Foo.vm, or Foo.xml when not emitting VM code.
+std::string GetOutputPath(const std::string& file_in, const CompilerOptions& options);
+
+// Compiles every .jack file named in |paths|, or found directly inside a
+// directory named there, writing Foo.vm (or Foo.xml) next to Foo.jack.
+// Classes are compiled in parallel; when emitting VM code, every class is
+// parsed before any is compiled, so that calls between them are checked
+// against each other's interfaces rather than files from an older build.
+// Returns one error message per class
+// that failed, ordered by file path so that the result does not depend on
+// scheduling.
+std::vector<std::string> CompileSources(const std::vector<std::string>& paths,
+                                        const CompilerOptions& options);
+
+// Compiles the classes found as by CompileSources as one closed program
+// into the single VM file |file_out|, with whole-program optimization: see
+// ProgramOptimizer. The OS may be among the classes or, as VM code, be
+// linked in later. Returns one error message per failure.
+std::vector<std::string> CompileProgram(const std::vector<std::string>& paths,
+                                        const std::string& file_out,
+                                        const CompilerOptions& options);
+
+#endif
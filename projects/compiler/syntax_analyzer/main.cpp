@@ -1,19 +1,99 @@
-#include "./token.hpp"
-#include "./tokenizer.hpp"
-#include "./compilation-engine.hpp"
+#include "./compile-daemon.hpp"
+#include "./jack-compiler.hpp"
 
-#include <fstream>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
 #include <string>
 #include <vector>
 
+namespace {
+  // Compile to VM code instead of writing the XML parse tree.
+  constexpr char kVMFlag[] = "--vm";
+  // -j<N>: number of worker threads for multi-class builds.
+  constexpr char kThreadsPrefix[] = "-j";
+  // Stay running and serve build requests on stdin; see CompileDaemon.
+  constexpr char kDaemonFlag[] = "--daemon";
+  // --whole-program=<output.vm>: compile all classes as one optimized
+  // program; see CompileProgram.
+  constexpr char kWholeProgramPrefix[] = "--whole-program=";
+  constexpr char kJackExtension[] = ".jack";
+
+  bool IsJackFile(const std::string& filename) {
+    return filename.size() >= 5 && filename.substr(filename.size() - 5) == kJackExtension;
+  }
+
+  void PrintUsage() {
+    std::cerr << "Usage: syntax_analyzer [--vm] <input.jack> <output>\n"
+              << "       syntax_analyzer [--vm] [-j<threads>] <file.jack | directory>...\n"
+              << "       syntax_analyzer --daemon [--vm] [-j<threads>] <directory>\n"
+              << "       syntax_analyzer --whole-program=<output.vm> [-j<threads>]"
+              << " <file.jack | directory>...\n";
+  }
+}
+
 int main(int argc, char** argv) {
-  CompilationEngine analyzer(argv[1]);
-  std::vector<std::string> xml = analyzer.CompileClass();
-  std::ofstream out(argv[2]);
+  CompilerOptions options;
+  bool run_daemon = false;
+  std::string program_out;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg == kVMFlag) {
+      options.emit_vm = true;
+    } else if (arg == kDaemonFlag) {
+      run_daemon = true;
+    } else if (arg.compare(0, sizeof(kWholeProgramPrefix) - 1, kWholeProgramPrefix) == 0 &&
+               arg.size() > sizeof(kWholeProgramPrefix) - 1) {
+      program_out = arg.substr(sizeof(kWholeProgramPrefix) - 1);
+      options.emit_vm = true;
+    } else if (arg.compare(0, 2, kThreadsPrefix) == 0 && arg.size() > 2) {
+      options.num_threads = std::atoi(arg.c_str() + 2);
+    } else if (!arg.empty() && arg[0] == '-') {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage();
+      return 1;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if (paths.empty()) {
+    PrintUsage();
+    return 1;
+  }
+
+  if (run_daemon) {
+    if (paths.size() != 1) {
+      PrintUsage();
+      return 1;
+    }
+    CompileDaemon(paths[0], options).Serve(std::cin, std::cout);
+    return 0;
+  }
+
+  if (!program_out.empty()) {
+    std::vector<std::string> errors = CompileProgram(paths, program_out, options);
+    for (const auto& error : errors) {
+      std::cerr << error << "\n";
+    }
+    return errors.empty() ? 0 : 1;
+  }
+
+  // <input.jack> <output> compiles one class to a named output file;
+  // anything else is a list of classes and directories to build in place.
+  if (paths.size() == 2 && IsJackFile(paths[0]) && !IsJackFile(paths[1])) {
+    try {
+      CompileFile(paths[0], paths[1], options);
+    } catch (const std::exception& e) {
+      std::cerr << paths[0] << ": " << e.what() << "\n";
+      return 1;
+    }
+    return 0;
+  }
 
-  for (auto& line : xml) {
-    out << line << std::endl;
+  std::vector<std::string> errors = CompileSources(paths, options);
+  for (const auto& error : errors) {
+    std::cerr << error << "\n";
   }
-  out.close();
-  return 0;
+  return errors.empty() ? 0 : 1;
 }
@@ -0,0 +1,330 @@
+#include "./program-optimizer.hpp"
+#include "./symbol-table.hpp"
+
+#include <deque>
+
+namespace {
+  typedef std::pair<std::string_view, std::string_view> MemberKey;
+
+  // Sys.init when the OS is part of the program, Main.main when it is not.
+  constexpr MemberKey kEntryPoints[] = { { "Sys", "init" }, { "Main", "main" } };
+
+  // Calls that CodeGenerator emits without the source spelling them out.
+  constexpr MemberKey kAllocCall = { "Memory", "alloc" };
+  constexpr MemberKey kMultiplyCall = { "Math", "multiply" };
+  constexpr MemberKey kDivideCall = { "Math", "divide" };
+  constexpr MemberKey kStringNewCall = { "String", "new" };
+  constexpr MemberKey kAppendCharCall = { "String", "appendChar" };
+
+  std::string_view GetTypeName(const Token& type) {
+    if (type.GetType() == Token::TokenType::KEYWORD) {
+      return Token::KeywordToString(type.GetKeyword());
+    }
+    return type.GetIdentifier();
+  }
+
+  // Whether |node| is nothing but the variable |name|.
+  bool IsVariable(const ExpressionNode* node, std::string_view name) {
+    return node != nullptr && node->operations.empty() &&
+           node->first->type == TermNode::TermType::VARIABLE &&
+           node->first->token.GetIdentifier() == name;
+  }
+
+  // Walks the subroutines of one class, recording the fields they read
+  // and the subroutines they call. Names are resolved the way
+  // CodeGenerator resolves them.
+  class UseCollector {
+   public:
+    UseCollector(const ClassNode& node,
+                 const std::map<MemberKey, ProgramOptimizer::Accessor>& accessors) :
+      class_name_(node.name.GetIdentifier()), accessors_(accessors),
+      read_fields_(nullptr), calls_(nullptr), inlined_calls_(nullptr) {
+      for (const VarDecNode* var_dec : node.var_decs) {
+        SymbolTable::Kind kind = var_dec->keyword.GetKeyword() == Token::Keyword::STATIC ?
+          SymbolTable::Kind::STATIC : SymbolTable::Kind::FIELD;
+        for (const Token& name : var_dec->names) {
+          symbol_table_.Define(name.GetIdentifier(), GetTypeName(var_dec->type), kind);
+        }
+      }
+    }
+
+    // Accessor calls, which are compiled inline, go to |inlined_calls|.
+    void CollectSubroutine(const SubroutineDecNode& node, std::set<MemberKey>* read_fields,
+                           std::set<MemberKey>* calls, std::set<MemberKey>* inlined_calls) {
+      read_fields_ = read_fields;
+      calls_ = calls;
+      inlined_calls_ = inlined_calls;
+      symbol_table_.StartSubroutine();
+      for (const ParameterNode& parameter : node.parameters) {
+        symbol_table_.Define(parameter.name.GetIdentifier(), GetTypeName(parameter.type),
+                             SymbolTable::Kind::ARG);
+      }
+      for (const VarDecNode* var_dec : node.body->var_decs) {
+        for (const Token& name : var_dec->names) {
+          symbol_table_.Define(name.GetIdentifier(), GetTypeName(var_dec->type),
+                               SymbolTable::Kind::VAR);
+        }
+      }
+      if (node.keyword.GetKeyword() == Token::Keyword::CONSTRUCTOR) {
+        calls_->insert(kAllocCall);
+      }
+      CollectStatements(node.body->statements);
+    }
+
+   private:
+    void CollectStatements(const ArenaArray<StatementNode*>& statements) {
+      for (const StatementNode* statement : statements) {
+        if (statement->type == StatementNode::StatementType::LET &&
+            statement->index != nullptr) {
+          // a[i] = ... reads a.
+          Read(statement->var_name);
+        }
+        if (statement->index != nullptr) {
+          CollectExpression(*statement->index);
+        }
+        if (statement->expression != nullptr) {
+          CollectExpression(*statement->expression);
+        }
+        if (statement->call != nullptr) {
+          CollectCall(*statement->call);
+        }
+        CollectStatements(statement->statements);
+        CollectStatements(statement->else_statements);
+      }
+    }
+
+    void CollectExpression(const ExpressionNode& node) {
+      CollectTerm(*node.first);
+      for (const OperationNode& operation : node.operations) {
+        CollectTerm(*operation.term);
+        char op = operation.op.GetSymbol();
+        if (op == '*') {
+          calls_->insert(kMultiplyCall);
+        } else if (op == '/') {
+          calls_->insert(kDivideCall);
+        }
+      }
+    }
+
+    void CollectTerm(const TermNode& node) {
+      switch (node.type) {
+        case TermNode::TermType::STRING_CONSTANT:
+          calls_->insert(kStringNewCall);
+          calls_->insert(kAppendCharCall);
+          break;
+        case TermNode::TermType::VARIABLE:
+          Read(node.token);
+          break;
+        case TermNode::TermType::ARRAY_ELEMENT:
+          Read(node.token);
+          CollectExpression(*node.expression);
+          break;
+        case TermNode::TermType::SUBROUTINE_CALL:
+          CollectCall(*node.call);
+          break;
+        case TermNode::TermType::PARENTHESIZED:
+          CollectExpression(*node.expression);
+          break;
+        case TermNode::TermType::UNARY_OP:
+          CollectTerm(*node.operand);
+          break;
+        default:
+          break;
+      }
+    }
+
+    void CollectCall(const SubroutineCallNode& node) {
+      std::string_view class_name = class_name_;
+      bool is_method_call = !node.has_receiver;
+      if (node.has_receiver) {
+        const SymbolTable::Symbol* receiver =
+          symbol_table_.Find(node.receiver.GetIdentifier());
+        if (receiver != nullptr) {
+          Read(node.receiver);
+          class_name = receiver->type;
+          is_method_call = true;
+        } else {
+          class_name = node.receiver.GetIdentifier();
+        }
+      }
+      MemberKey callee(class_name, node.name.GetIdentifier());
+      if (is_method_call && accessors_.find(callee) != accessors_.end()) {
+        inlined_calls_->insert(callee);
+      } else {
+        calls_->insert(callee);
+      }
+      for (const ExpressionNode* argument : node.arguments) {
+        CollectExpression(*argument);
+      }
+    }
+
+    void Read(const Token& name) {
+      const SymbolTable::Symbol* symbol = symbol_table_.Find(name.GetIdentifier());
+      if (symbol != nullptr && symbol->kind == SymbolTable::Kind::FIELD) {
+        read_fields_->emplace(class_name_, name.GetIdentifier());
+      }
+    }
+
+    std::string_view class_name_;
+    const std::map<MemberKey, ProgramOptimizer::Accessor>& accessors_;
+    std::set<MemberKey>* read_fields_;
+    std::set<MemberKey>* calls_;
+    std::set<MemberKey>* inlined_calls_;
+    SymbolTable symbol_table_;
+  };
+}
+
+ProgramOptimizer::ProgramOptimizer(const std::vector<const ClassNode*>& classes) :
+  has_entry_point_(false) {
+  // Accessor -> the field it reads or writes.
+  std::map<MemberKey, MemberKey> accessor_fields;
+  for (const ClassNode* node : classes) {
+    FindAccessors(*node, &accessor_fields);
+  }
+
+  std::map<MemberKey, std::set<MemberKey>> read_fields;
+  std::map<MemberKey, std::set<MemberKey>> calls;
+  std::map<MemberKey, std::set<MemberKey>> inlined_calls;
+  for (const ClassNode* node : classes) {
+    std::string_view class_name = node->name.GetIdentifier();
+    UseCollector collector(*node, accessors_);
+    for (const SubroutineDecNode* subroutine : node->subroutines) {
+      MemberKey key(class_name, subroutine->name.GetIdentifier());
+      collector.CollectSubroutine(*subroutine, &read_fields[key], &calls[key],
+                                  &inlined_calls[key]);
+    }
+  }
+  FindReachable(calls);
+
+  // Only code that is emitted, directly or inline, keeps a field alive.
+  std::set<MemberKey> live_fields;
+  for (const auto& subroutine : read_fields) {
+    if (!IsReachable(subroutine.first.first, subroutine.first.second)) {
+      continue;
+    }
+    live_fields.insert(subroutine.second.begin(), subroutine.second.end());
+    for (const MemberKey& accessor : inlined_calls[subroutine.first]) {
+      const std::set<MemberKey>& accessor_reads = read_fields[accessor];
+      live_fields.insert(accessor_reads.begin(), accessor_reads.end());
+    }
+  }
+
+  // Renumber the fields that are read, and point accessors at the new
+  // indices.
+  std::map<MemberKey, int> field_indices;
+  for (const ClassNode* node : classes) {
+    std::string_view class_name = node->name.GetIdentifier();
+    int next_index = 0;
+    for (const VarDecNode* var_dec : node->var_decs) {
+      if (var_dec->keyword.GetKeyword() != Token::Keyword::FIELD) {
+        continue;
+      }
+      for (const Token& name : var_dec->names) {
+        MemberKey field(class_name, name.GetIdentifier());
+        if (live_fields.find(field) == live_fields.end()) {
+          dropped_fields_.insert(field);
+          field_indices[field] = -1;
+        } else {
+          field_indices[field] = next_index++;
+        }
+      }
+    }
+  }
+  for (auto& accessor : accessors_) {
+    accessor.second.field_index = field_indices[accessor_fields[accessor.first]];
+  }
+}
+
+void ProgramOptimizer::FindAccessors(const ClassNode& node,
+                                     std::map<MemberKey, MemberKey>* accessor_fields) {
+  std::string_view class_name = node.name.GetIdentifier();
+  std::set<std::string_view> fields;
+  for (const VarDecNode* var_dec : node.var_decs) {
+    if (var_dec->keyword.GetKeyword() == Token::Keyword::FIELD) {
+      for (const Token& name : var_dec->names) {
+        fields.insert(name.GetIdentifier());
+      }
+    }
+  }
+
+  for (const SubroutineDecNode* subroutine : node.subroutines) {
+    const SubroutineBodyNode& body = *subroutine->body;
+    if (subroutine->keyword.GetKeyword() != Token::Keyword::METHOD ||
+        !body.var_decs.empty()) {
+      continue;
+    }
+    const ArenaArray<StatementNode*>& statements = body.statements;
+    MemberKey key(class_name, subroutine->name.GetIdentifier());
+    std::string_view field;
+    bool is_setter = false;
+
+    if (subroutine->parameters.empty() && statements.size() == 1 &&
+        statements[0]->type == StatementNode::StatementType::RETURN &&
+        statements[0]->expression != nullptr &&
+        statements[0]->expression->operations.empty() &&
+        statements[0]->expression->first->type == TermNode::TermType::VARIABLE) {
+      // return field;
+      field = statements[0]->expression->first->token.GetIdentifier();
+    } else if (subroutine->parameters.size() == 1 && statements.size() == 2 &&
+               statements[0]->type == StatementNode::StatementType::LET &&
+               statements[0]->index == nullptr &&
+               IsVariable(statements[0]->expression,
+                          subroutine->parameters[0].name.GetIdentifier()) &&
+               statements[1]->type == StatementNode::StatementType::RETURN &&
+               statements[1]->expression == nullptr) {
+      // let field = parameter; return;
+      field = statements[0]->var_name.GetIdentifier();
+      is_setter = true;
+    } else {
+      continue;
+    }
+    // A parameter may shadow the field.
+    if (fields.find(field) == fields.end() ||
+        (is_setter && field == subroutine->parameters[0].name.GetIdentifier())) {
+      continue;
+    }
+    accessors_[key] = { is_setter, 0 };
+    (*accessor_fields)[key] = MemberKey(class_name, field);
+  }
+}
+
+void ProgramOptimizer::FindReachable(const std::map<MemberKey, std::set<MemberKey>>& calls) {
+  std::deque<MemberKey> pending;
+  for (const MemberKey& entry_point : kEntryPoints) {
+    if (calls.find(entry_point) != calls.end()) {
+      has_entry_point_ = true;
+      reachable_.insert(entry_point);
+      pending.push_back(entry_point);
+    }
+  }
+  while (!pending.empty()) {
+    auto callees = calls.find(pending.front());
+    pending.pop_front();
+    if (callees == calls.end()) {
+      // Not part of the program.
+      continue;
+    }
+    for (const MemberKey& callee : callees->second) {
+      if (reachable_.insert(callee).second) {
+        pending.push_back(callee);
+      }
+    }
+  }
+}
+
+bool ProgramOptimizer::IsReachable(std::string_view class_name,
+                                   std::string_view subroutine_name) const {
+  return !has_entry_point_ ||
+         reachable_.find(MemberKey(class_name, subroutine_name)) != reachable_.end();
+}
+
+bool ProgramOptimizer::IsFieldDropped(std::string_view class_name,
+                                      std::string_view field_name) const {
+  return dropped_fields_.find(MemberKey(class_name, field_name)) != dropped_fields_.end();
+}
+
+const ProgramOptimizer::Accessor* ProgramOptimizer::FindAccessor(
+    std::string_view class_name, std::string_view subroutine_name) const {
+  auto it = accessors_.find(MemberKey(class_name, subroutine_name));
+  return it == accessors_.end() ? nullptr : &it->second;
+}
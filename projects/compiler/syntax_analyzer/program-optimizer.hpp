@@ -0,0 +1,58 @@
+#ifndef SYNTAX_ANALYZER_PROGRAM_OPTIMIZER_HPP_
+#define SYNTAX_ANALYZER_PROGRAM_OPTIMIZER_HPP_
+
+#include <map>
+#include <set>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "./ast.hpp"
+
+// Whole-program facts about a closed set of Jack classes, for
+// CodeGenerator to compile each of them better than it could alone:
+//
+// - Subroutines that cannot be reached from Sys.init or Main.main need
+//   not be emitted.
+// - Fields that are never read need no storage; writes to them only
+//   evaluate the assigned value.
+// - Accessor methods, whose body is just `return field;` or
+//   `let field = parameter; return;`, are compiled inline at every call.
+//
+// Classes the program calls but does not contain, such as an OS shipped
+// as VM code, are taken to call nothing back. The analysis refers to the
+// classes' trees, which must outlive it.
+class ProgramOptimizer {
+ public:
+  struct Accessor {
+    bool is_setter;
+    // The field's index once unread fields are dropped, or -1 for a
+    // setter of a dropped field.
+    int field_index;
+  };
+
+  explicit ProgramOptimizer(const std::vector<const ClassNode*>& classes);
+
+  bool IsReachable(std::string_view class_name, std::string_view subroutine_name) const;
+  bool IsFieldDropped(std::string_view class_name, std::string_view field_name) const;
+  // Returns null unless the subroutine is an accessor method.
+  const Accessor* FindAccessor(std::string_view class_name,
+                               std::string_view subroutine_name) const;
+
+ private:
+  // Class name and subroutine or field name.
+  typedef std::pair<std::string_view, std::string_view> MemberKey;
+
+  void FindAccessors(const ClassNode& node,
+                     std::map<MemberKey, MemberKey>* accessor_fields);
+  void FindReachable(const std::map<MemberKey, std::set<MemberKey>>& calls);
+
+  // False if the program has no entry point, in which case nothing is
+  // removed.
+  bool has_entry_point_;
+  std::set<MemberKey> reachable_;
+  std::set<MemberKey> dropped_fields_;
+  std::map<MemberKey, Accessor> accessors_;
+};
+
+#endif
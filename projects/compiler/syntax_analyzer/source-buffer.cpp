@@ -0,0 +1,57 @@
+#include "./source-buffer.hpp"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  // mmap() rejects zero-length mappings, so empty files point here.
+  constexpr char kEmptyBuffer[] = "";
+}
+
+SourceBuffer::SourceBuffer(const std::string& filename, Mode mode)
+  : data_(kEmptyBuffer), size_(0), is_mapped_(false) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + filename);
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) < 0) {
+    close(fd);
+    throw std::runtime_error("Cannot stat " + filename);
+  }
+
+  if (file_stat.st_size > 0 && mode == Mode::COPY) {
+    contents_.resize(file_stat.st_size);
+    size_t bytes_read = 0;
+    while (bytes_read < contents_.size()) {
+      ssize_t result = read(fd, &contents_[bytes_read], contents_.size() - bytes_read);
+      if (result <= 0) {
+        close(fd);
+        throw std::runtime_error("Cannot read " + filename);
+      }
+      bytes_read += result;
+    }
+    data_ = contents_.data();
+    size_ = contents_.size();
+  } else if (file_stat.st_size > 0) {
+    void* mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Cannot map " + filename);
+    }
+    data_ = static_cast<const char*>(mapping);
+    size_ = file_stat.st_size;
+    is_mapped_ = true;
+  }
+  close(fd);
+}
+
+SourceBuffer::~SourceBuffer() {
+  if (is_mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
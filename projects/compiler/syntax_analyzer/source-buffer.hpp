@@ -0,0 +1,37 @@
+#ifndef SYNTAX_ANALYZER_SOURCE_BUFFER_HPP_
+#define SYNTAX_ANALYZER_SOURCE_BUFFER_HPP_
+
+#include <cstddef>
+#include <string>
+
+// Read-only view over the contents of a source file. By default the file
+// is memory-mapped, so scanning it never copies or allocates per character.
+class SourceBuffer {
+ public:
+  enum class Mode {
+    MAP,
+    // Reads the file into memory owned by the buffer. A mapping shows
+    // later in-place rewrites of the file, so buffers that outlive the
+    // current contents of the file, as in the compile daemon, copy.
+    COPY
+  };
+
+  // Loads |filename|. Throws std::runtime_error if it cannot be read.
+  explicit SourceBuffer(const std::string& filename, Mode mode = Mode::MAP);
+  ~SourceBuffer();
+
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+  const char* begin() const { return data_; }
+  const char* end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  bool is_mapped_;
+  std::string contents_;
+};
+
+#endif
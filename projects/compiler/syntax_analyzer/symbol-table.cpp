@@ -0,0 +1,43 @@
+#include "./symbol-table.hpp"
+
+#include <stdexcept>
+#include <string>
+
+void SymbolTable::StartClass() {
+  class_scope_.clear();
+  counts_[static_cast<size_t>(Kind::STATIC)] = 0;
+  counts_[static_cast<size_t>(Kind::FIELD)] = 0;
+  StartSubroutine();
+}
+
+void SymbolTable::StartSubroutine() {
+  subroutine_scope_.clear();
+  counts_[static_cast<size_t>(Kind::ARG)] = 0;
+  counts_[static_cast<size_t>(Kind::VAR)] = 0;
+}
+
+void SymbolTable::Define(std::string_view name, std::string_view type, Kind kind) {
+  auto& scope = kind == Kind::STATIC || kind == Kind::FIELD ?
+    class_scope_ : subroutine_scope_;
+  int& count = counts_[static_cast<size_t>(kind)];
+  if (!scope.emplace(name, Symbol{ type, kind, count }).second) {
+    throw std::runtime_error("Variable defined twice: " + std::string(name));
+  }
+  count++;
+}
+
+const SymbolTable::Symbol* SymbolTable::Find(std::string_view name) const {
+  auto symbol = subroutine_scope_.find(name);
+  if (symbol != subroutine_scope_.end()) {
+    return &symbol->second;
+  }
+  symbol = class_scope_.find(name);
+  if (symbol != class_scope_.end()) {
+    return &symbol->second;
+  }
+  return nullptr;
+}
+
+int SymbolTable::GetCount(Kind kind) const {
+  return counts_[static_cast<size_t>(kind)];
+}
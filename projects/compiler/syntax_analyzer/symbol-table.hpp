@@ -0,0 +1,47 @@
+#ifndef SYNTAX_ANALYZER_SYMBOL_TABLE_HPP_
+#define SYNTAX_ANALYZER_SYMBOL_TABLE_HPP_
+
+#include <array>
+#include <string_view>
+#include <unordered_map>
+
+// Class- and subroutine-scope variables of the Jack class being compiled.
+// Names and types are views into the class's source buffer.
+class SymbolTable {
+ public:
+  enum class Kind {
+    STATIC,
+    FIELD,
+    ARG,
+    VAR
+  };
+
+  struct Symbol {
+    std::string_view type;
+    Kind kind;
+    int index;
+  };
+
+  SymbolTable() : counts_({}) {}
+
+  // Forgets every static and field, e.g. before compiling another class.
+  void StartClass();
+  // Forgets every argument and local variable.
+  void StartSubroutine();
+  // Defines |name| in the scope that |kind| belongs to, with the next free
+  // index of that kind. Throws std::runtime_error if the name is already
+  // defined in that scope.
+  void Define(std::string_view name, std::string_view type, Kind kind);
+  // Looks |name| up in the subroutine scope, then the class scope. Returns
+  // null if it is not defined in either.
+  const Symbol* Find(std::string_view name) const;
+  // Number of variables of |kind| defined in the current scopes.
+  int GetCount(Kind kind) const;
+
+ private:
+  std::unordered_map<std::string_view, Symbol> class_scope_;
+  std::unordered_map<std::string_view, Symbol> subroutine_scope_;
+  std::array<int, 4> counts_;
+};
+
+#endif
@@ -0,0 +1,93 @@
+// Checks the VM code the compiler writes for loops and branches whose
+// conditions are known at compile time or cannot be trusted to be 0 or -1.
+//
+// Build and run from projects/compiler/syntax_analyzer:
+//   g++ -std=c++17 -O2 -o control-flow-test tests/control-flow-test.cpp $(ls *.cpp | grep -v main.cpp) -lboost_filesystem -lpthread
+//   ./control-flow-test
+
+#include "../jack-compiler.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+  // Compiles |body| as the body of Main.main, with a boolean local b and
+  // an int local i, and returns the VM code.
+  std::string CompileMain(const std::string& body) {
+    boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+    std::string file_in = (directory / "Main.jack").string();
+    std::string file_out = (directory / "Main.vm").string();
+    std::ofstream(file_in) << "class Main {\n"
+                           << "  function void main() {\n"
+                           << "    var boolean b;\n"
+                           << "    var int i;\n"
+                           << body
+                           << "    return;\n"
+                           << "  }\n"
+                           << "}\n";
+    CompilerOptions options;
+    options.emit_vm = true;
+    CompileFile(file_in, file_out, options);
+    std::ifstream in(file_out);
+    std::stringstream vm;
+    vm << in.rdbuf();
+    boost::filesystem::remove_all(directory);
+    return vm.str();
+  }
+
+  bool Check(bool condition, const std::string& name, const std::string& vm) {
+    if (!condition) {
+      std::cerr << "FAILED: " << name << "\n" << vm;
+    }
+    return condition;
+  }
+}
+
+int main() {
+  bool passed = true;
+
+  // The loop is just its body and the jump back: no condition is pushed
+  // or tested.
+  std::string vm = CompileMain("    while (true) { let i = i + 1; }\n");
+  passed &= Check(vm == "function Main.main 2\n"
+                        "label WHILE_EXP0\n"
+                        "push local 1\n"
+                        "push constant 1\n"
+                        "add\n"
+                        "pop local 1\n"
+                        "goto WHILE_EXP0\n"
+                        "push constant 0\n"
+                        "return\n",
+                  "while (true) emits no condition code", vm);
+
+  // A boolean variable may hold 1, so ~b is not folded into the branch.
+  vm = CompileMain("    let b = 1;\n"
+                   "    if (~b) { let i = 7; }\n");
+  passed &= Check(vm.find("push local 0\n"
+                          "not\n"
+                          "if-goto IF_TRUE0\n"
+                          "goto IF_FALSE0\n") != std::string::npos,
+                  "if (~b) tests ~b as any value", vm);
+
+  // As in the reference compiler, while (b) runs the body only while b is
+  // true (-1): it leaves the loop when ~b is not 0, so b = 1 ends it. A
+  // boolean variable is not assumed to be 0 or -1, so the test is not
+  // folded into an if-goto on b.
+  vm = CompileMain("    let b = 1;\n"
+                   "    while (b) { let b = b - 1; }\n");
+  passed &= Check(vm.find("label WHILE_EXP0\n"
+                          "push local 0\n"
+                          "not\n"
+                          "if-goto WHILE_END0\n"
+                          "goto WHILE_BODY0\n") != std::string::npos,
+                  "while (b) loops only while b is true (-1)", vm);
+
+  std::cout << (passed ? "PASSED" : "FAILED") << "\n";
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Checks that multiplications by a constant are expanded into
+// shift-and-add only while that is short, and call Math.multiply
+// otherwise.
+//
+// Build and run from projects/compiler/syntax_analyzer:
+//   g++ -std=c++17 -O2 -o multiply-test tests/multiply-test.cpp $(ls *.cpp | grep -v main.cpp) -lboost_filesystem -lpthread
+//   ./multiply-test
+
+#include "../jack-compiler.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+  constexpr char kMultiplyCall[] = "call Math.multiply 2\n";
+
+  // Compiles `let i = i * <factor>;` as the body of Main.main, with an
+  // int local i, and returns the VM code.
+  std::string CompileMultiply(const std::string& factor) {
+    boost::filesystem::path directory =
+      boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+    std::string file_in = (directory / "Main.jack").string();
+    std::string file_out = (directory / "Main.vm").string();
+    std::ofstream(file_in) << "class Main {\n"
+                           << "  function void main() {\n"
+                           << "    var int i;\n"
+                           << "    let i = i * " << factor << ";\n"
+                           << "    return;\n"
+                           << "  }\n"
+                           << "}\n";
+    CompilerOptions options;
+    options.emit_vm = true;
+    CompileFile(file_in, file_out, options);
+    std::ifstream in(file_out);
+    std::stringstream vm;
+    vm << in.rdbuf();
+    boost::filesystem::remove_all(directory);
+    return vm.str();
+  }
+
+  bool Check(bool condition, const std::string& name, const std::string& vm) {
+    if (!condition) {
+      std::cerr << "FAILED: " << name << "\n" << vm;
+    }
+    return condition;
+  }
+}
+
+int main() {
+  bool passed = true;
+
+  // Two set bits: i * 8 + i * 2, with no call.
+  std::string vm = CompileMultiply("10");
+  passed &= Check(vm.find(kMultiplyCall) == std::string::npos,
+                  "i * 10 is shift-and-add", vm);
+
+  // 12345 has six set bits: the call is far shorter.
+  vm = CompileMultiply("12345");
+  passed &= Check(vm == "function Main.main 1\n"
+                        "push local 0\n"
+                        "push constant 12345\n"
+                        "call Math.multiply 2\n"
+                        "pop local 0\n"
+                        "push constant 0\n"
+                        "return\n",
+                  "i * 12345 calls Math.multiply", vm);
+
+  // A single bit, but fourteen doublings.
+  vm = CompileMultiply("16384");
+  passed &= Check(vm.find(kMultiplyCall) != std::string::npos,
+                  "i * 16384 calls Math.multiply", vm);
+
+  std::cout << (passed ? "PASSED" : "FAILED") << "\n";
+  return passed ? 0 : 1;
+}
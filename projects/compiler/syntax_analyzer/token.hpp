@@ -1,8 +1,10 @@
 #ifndef SYNTAX_ANALYZER_TOKEN_HPP
 #define SYNTAX_ANALYZER_TOKEN_HPP
 
-#include <boost/optional.hpp>
-#include <string>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+#include <type_traits>
 
 class TokenTypeException : public std::exception {
   virtual const char* what() const throw() {
@@ -10,9 +12,22 @@ class TokenTypeException : public std::exception {
   }
 };
 
+// A single Jack token. Tokens are 16 bytes and trivially copyable so that
+// the parser can look ahead and pass them around freely:
+//
+//   - identifier and string constant tokens are spans into the tokenizer's
+//     source buffer, which must outlive the token;
+//   - keywords and symbols are stored as one byte, integer constants as a
+//     16-bit value (Jack constants are at most 32767);
+//   - the 1-based line and column of the token's first character are kept
+//     for error messages, saturating at kMaxLine and kMaxColumn.
 class Token {
 public:
-  enum class TokenType {
+  static constexpr uint32_t kMaxLine = (1 << 20) - 1;
+  static constexpr uint32_t kMaxColumn = (1 << 12) - 1;
+  static constexpr size_t kMaxTextLength = UINT16_MAX;
+
+  enum class TokenType : uint8_t {
     TOKEN_TYPE_UNSPECIFIED,
     KEYWORD,
     SYMBOL,
@@ -21,7 +36,7 @@ public:
     CONST_STRING
   };
 
-  enum class Keyword {
+  enum class Keyword : uint8_t {
     CLASS,
     METHOD,
     FUNCTION,
@@ -45,39 +60,61 @@ public:
     THIS
   };
 
-  Token(TokenType type) : type_(type) {}
+  Token() : Token(TokenType::TOKEN_TYPE_UNSPECIFIED) {}
+
+  Token(TokenType type) : text_(nullptr), line_(0), column_(0), length_(0),
+    type_(type), code_(0) {}
 
   Token(TokenType type, Keyword keyword) : Token(type) {
-    keyword_ = keyword;
+    code_ = static_cast<uint8_t>(keyword);
   }
 
   Token(TokenType type, char symbol) : Token(type) {
-    symbol_ = symbol;
+    code_ = static_cast<uint8_t>(symbol);
   }
 
-  Token(TokenType type, const std::string& string_value) : Token(type) {
-    string_value_ = string_value;
+  // |text| is a span into the tokenizer's source buffer, which must outlive
+  // the token. It may be at most kMaxTextLength characters long.
+  Token(TokenType type, std::string_view text) : Token(type) {
+    text_ = text.data();
+    length_ = static_cast<uint16_t>(text.size());
   }
 
+  // |int_value| must be in [0, 32767].
   Token(TokenType type, int int_value) : Token(type) {
-    const_int_ = int_value;
+    length_ = static_cast<uint16_t>(int_value);
   }
 
+  // Returns the source spelling of |keyword|, e.g. "class".
+  static std::string_view KeywordToString(Keyword keyword);
+
+  // Records where the token starts; values past kMaxLine and kMaxColumn
+  // are clamped.
+  void SetLocation(size_t line, size_t column);
+
   TokenType GetType() const;
   char GetSymbol() const;
   Keyword GetKeyword() const;
-  std::string GetIdentifier() const;
+  std::string_view GetIdentifier() const;
   int GetIntConstant() const;
-  std::string GetStringConstant() const;
-  std::string ToXML() const;
+  std::string_view GetStringConstant() const;
+  size_t GetLine() const;
+  size_t GetColumn() const;
 
 private:
   void CheckTokenTypeIs(TokenType expected_type) const;
+  const char* text_;
+  uint32_t line_ : 20;
+  uint32_t column_ : 12;
+  // Length of |text_|, or the value of an integer constant.
+  uint16_t length_;
   TokenType type_;
-  boost::optional<Keyword> keyword_;
-  boost::optional<char> symbol_;
-  boost::optional<std::string> string_value_;
-  boost::optional<int> const_int_;
+  // The Keyword or symbol character.
+  uint8_t code_;
 };
 
+static_assert(sizeof(Token) == 16, "Token should fit in 16 bytes");
+static_assert(std::is_trivially_copyable<Token>::value,
+              "Token should be trivially copyable");
+
 #endif
@@ -1,28 +1,60 @@
 #include "./tokenizer.hpp"
 
-#include <map>
-#include <set>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <utility>
 
 namespace {
-  constexpr char kTabChar = '\t';
-  constexpr char kCarriageReturnChar = '\r';
-  constexpr char kNewLineChar = '\n';
-  constexpr char kSpaceChar = ' ';
   constexpr char kStringDelimiterChar = '"';
-  constexpr char kBlockCommentSequence[] = "/**";
-  constexpr char kEndBlockCommentSequence[] = "*/";
-  constexpr char kBackslashChar = '/';
+  constexpr char kSlashChar = '/';
   constexpr char kStarChar = '*';
+  constexpr char kNewLineChar = '\n';
+  constexpr char kSymbolChars[] = "{}()[].,;+-*/&|<>=~";
+  constexpr int kMaxIntConstant = 32767;
+
+  // Character classes, as bit flags so that e.g. "part of an identifier" is
+  // a single mask test.
+  constexpr uint8_t kWhitespaceClass = 1 << 0;
+  constexpr uint8_t kSymbolClass = 1 << 1;
+  constexpr uint8_t kDigitClass = 1 << 2;
+  constexpr uint8_t kLetterClass = 1 << 3;
+  constexpr uint8_t kIdentifierClass = kDigitClass | kLetterClass;
+
+  constexpr std::array<uint8_t, 256> BuildCharClassTable() {
+    std::array<uint8_t, 256> table {};
+    table[' '] = table['\t'] = table['\r'] = table['\n'] = kWhitespaceClass;
+    for (const char* c = kSymbolChars; *c != '\0'; c++) {
+      table[static_cast<unsigned char>(*c)] = kSymbolClass;
+    }
+    for (char c = '0'; c <= '9'; c++) {
+      table[static_cast<unsigned char>(c)] = kDigitClass;
+    }
+    for (char c = 'a'; c <= 'z'; c++) {
+      table[static_cast<unsigned char>(c)] = kLetterClass;
+    }
+    for (char c = 'A'; c <= 'Z'; c++) {
+      table[static_cast<unsigned char>(c)] = kLetterClass;
+    }
+    table['_'] = kLetterClass;
+    return table;
+  }
 
-  const std::set<char> kSymbolChars = {
-    '{', '}', '(', ')', '[', ']', '.', ',', ';', '+',
-    '-', '*', '/', '&', '|', '<', '>', '=', '~'
+  constexpr std::array<uint8_t, 256> kCharClasses = BuildCharClassTable();
+
+  inline bool IsOfClass(char c, uint8_t char_class) {
+    return (kCharClasses[static_cast<unsigned char>(c)] & char_class) != 0;
+  }
+
+  struct KeywordEntry {
+    std::string_view text;
+    Token::Keyword keyword;
   };
 
-  const std::map<std::string, Token::Keyword> kKeywordsMap= {
+  constexpr KeywordEntry kKeywords[] = {
     { "class", Token::Keyword::CLASS },
     { "method", Token::Keyword::METHOD },
     { "function", Token::Keyword::FUNCTION },
@@ -45,148 +77,224 @@ namespace {
     { "null", Token::Keyword::NULL_KEYWORD },
     { "this", Token::Keyword::THIS },
   };
+  constexpr size_t kNumKeywords = sizeof(kKeywords) / sizeof(kKeywords[0]);
+
+  // Perfect hash over kKeywords: first char, last char and length select a
+  // unique slot for every keyword. Coefficients were found by search; the
+  // static_assert below rejects them if the keyword list ever changes.
+  constexpr size_t kKeywordTableSize = 32;
+  constexpr int kEmptyKeywordSlot = -1;
+
+  constexpr size_t HashKeyword(std::string_view text) {
+    return (static_cast<unsigned char>(text.front()) * 8 +
+            static_cast<unsigned char>(text.back()) * 27 +
+            text.size()) % kKeywordTableSize;
+  }
+
+  constexpr std::array<int, kKeywordTableSize> BuildKeywordTable() {
+    std::array<int, kKeywordTableSize> table {};
+    for (auto& slot : table) {
+      slot = kEmptyKeywordSlot;
+    }
+    for (size_t i = 0; i < kNumKeywords; i++) {
+      table[HashKeyword(kKeywords[i].text)] = static_cast<int>(i);
+    }
+    return table;
+  }
+
+  constexpr std::array<int, kKeywordTableSize> kKeywordTable = BuildKeywordTable();
+
+  constexpr bool IsKeywordHashPerfect() {
+    for (size_t i = 0; i < kNumKeywords; i++) {
+      if (kKeywordTable[HashKeyword(kKeywords[i].text)] != static_cast<int>(i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  static_assert(IsKeywordHashPerfect(), "Keyword hash has collisions");
+
+  // Returns the first occurrence of |c| in [begin, end), or |end|. memchr
+  // is vectorized by the C library, so long comments and strings are
+  // skipped many bytes at a time.
+  inline const char* FindChar(const char* begin, const char* end, char c) {
+    const void* found = std::memchr(begin, c, end - begin);
+    return found == nullptr ? end : static_cast<const char*>(found);
+  }
+
+  // Returns the index into kKeywords of |text|, or kEmptyKeywordSlot.
+  inline int FindKeyword(std::string_view text) {
+    int slot = kKeywordTable[HashKeyword(text)];
+    if (slot != kEmptyKeywordSlot && kKeywords[slot].text == text) {
+      return slot;
+    }
+    return kEmptyKeywordSlot;
+  }
 }
 
 Tokenizer::Tokenizer(const std::string& filename) :
-  stream_(filename) {
+  Tokenizer(std::make_shared<const SourceBuffer>(filename)) {}
+
+Tokenizer::Tokenizer(std::shared_ptr<const SourceBuffer> source) :
+  Tokenizer(source, source->begin(), source->end()) {}
+
+Tokenizer::Tokenizer(std::shared_ptr<const SourceBuffer> source,
+                     const char* begin, const char* end) :
+  next_token_start_(begin), source_(std::move(source)), position_(begin), end_(end),
+  line_(1), line_start_(source_->begin()) {
+  CountNewLines(source_->begin(), begin);
   Advance();
 }
 
-Token Tokenizer::GetNextToken() {
+const Token& Tokenizer::GetNextToken() const {
   if (!HasNextToken()) {
     throw std::runtime_error("No more tokens!");
   }
   return *next_token_;
 }
 
+const char* Tokenizer::GetNextTokenStart() const {
+  return next_token_start_;
+}
+
+void Tokenizer::SetNextToken(const Token& token, const char* start) {
+  next_token_ = token;
+  next_token_start_ = start;
+  next_token_->SetLocation(line_, start - line_start_ + 1);
+}
+
 void Tokenizer::UnsetNextToken() {
   next_token_ = boost::none;
 }
 
+std::shared_ptr<const SourceBuffer> Tokenizer::GetSource() const {
+  return source_;
+}
+
 bool Tokenizer::HasNextToken() const {
   return next_token_ != boost::none;
 }
 
 void Tokenizer::Advance() {
-  if (HasNextToken()) {
-  }
   UnsetNextToken();
-  std::stringstream sequence;
+  const char* end = end_;
 
-  while (!HasNextToken() && stream_.HasMoreChars()) {
-    char c = stream_.GetNextChar();
+  while (position_ != end) {
+    char c = *position_;
 
-    // Disregard space, newline, and carriage return chars.
-    if (c == kSpaceChar || c == kNewLineChar ||
-        c == kCarriageReturnChar || c == kTabChar) {
+    // Disregard space, newline, carriage return and tab chars.
+    if (IsOfClass(c, kWhitespaceClass)) {
+      position_++;
+      if (c == kNewLineChar) {
+        line_++;
+        line_start_ = position_;
+      }
       continue;
     }
 
-    // Disregard line comments.
-    if (c == kBackslashChar && stream_.PeekNextChar() == kBackslashChar) {
-      stream_.ConsumeStreamThrough(std::string(1, kNewLineChar));
-      continue;
+    // Disregard line and block comments.
+    if (c == kSlashChar && position_ + 1 != end) {
+      if (position_[1] == kSlashChar) {
+        SkipLineComment();
+        continue;
+      }
+      if (position_[1] == kStarChar) {
+        SkipBlockComment();
+        continue;
+      }
     }
 
-    // Disregard block comments.
-    if (c == kBackslashChar && stream_.PeekNextChar() == kStarChar) {
-      stream_.ConsumeStreamThrough(kEndBlockCommentSequence);
-      continue;
+    // A string constant runs up to the next delimiter; the token is a span
+    // over its contents.
+    if (c == kStringDelimiterChar) {
+      const char* start = position_ + 1;
+      const char* terminator = FindChar(start, end, kStringDelimiterChar);
+      if (terminator == end) {
+        throw std::runtime_error("Unterminated string constant!");
+      }
+      if (static_cast<size_t>(terminator - start) > Token::kMaxTextLength) {
+        throw std::runtime_error("String constant too long!");
+      }
+      SetNextToken(Token(Token::TokenType::CONST_STRING,
+                         std::string_view(start, terminator - start)),
+                   position_);
+      CountNewLines(start, terminator);
+      position_ = terminator + 1;
+      return;
     }
 
-    // If this is the start of a string, parse a new CONST_STRING token by
-    // consuming the stream until the terminating delimiter.
-    if (c == kStringDelimiterChar) {
-      std::string string_const = stream_.ConsumeStreamThrough(
-        std::string(1, kStringDelimiterChar));
-      next_token_ = Token(Token::TokenType::CONST_STRING, string_const);
+    if (IsOfClass(c, kSymbolClass)) {
+      SetNextToken(Token(Token::TokenType::SYMBOL, c), position_);
+      position_++;
       return;
     }
 
-    // If this is a symbol char, parse a new SYMBOL token and return.
-    if (kSymbolChars.find(c) != kSymbolChars.end()) {
-      next_token_ = Token(Token::TokenType::SYMBOL, c);
+    if (IsOfClass(c, kDigitClass)) {
+      const char* start = position_;
+      int value = 0;
+      while (position_ != end && IsOfClass(*position_, kDigitClass)) {
+        value = value * 10 + (*position_ - '0');
+        if (value > kMaxIntConstant) {
+          throw std::runtime_error("Integer constant too large!");
+        }
+        position_++;
+      }
+      SetNextToken(Token(Token::TokenType::CONST_INT, value), start);
       return;
     }
 
-    // If we've reached here, we know this char is part of a KEYWORD, CONST_INT
-    // or IDENTIFIER.
-    sequence << c;
-    std::string curr_seq = sequence.str();
-
-    // KEYWORD, CONST_INT, and IDENTIFIER tokens are always terminated by a
-    // space or a symbol. If the next (unconsumed) char in the stream is either
-    // of those, we can immediately parse the token. If not, we need to continue
-    // to build the token.
-    if (stream_.PeekNextChar() == kSpaceChar ||
-        kSymbolChars.find(stream_.PeekNextChar()) != kSymbolChars.end()) {
-      std::string token_str = sequence.str();
-      if (kKeywordsMap.find(token_str) != kKeywordsMap.end()) {
-        next_token_ =
-          Token(Token::TokenType::KEYWORD, kKeywordsMap.at(token_str));
-      } else if (isdigit(token_str[0])) {
-        next_token_ = Token(Token::TokenType::CONST_INT, atoi(token_str.c_str()));
+    if (IsOfClass(c, kLetterClass)) {
+      const char* start = position_;
+      while (position_ != end && IsOfClass(*position_, kIdentifierClass)) {
+        position_++;
+      }
+      std::string_view text(start, position_ - start);
+      int keyword = FindKeyword(text);
+      if (keyword != kEmptyKeywordSlot) {
+        SetNextToken(Token(Token::TokenType::KEYWORD, kKeywords[keyword].keyword),
+                     start);
       } else {
-        next_token_ = Token(Token::TokenType::IDENTIFIER, token_str);
+        if (text.size() > Token::kMaxTextLength) {
+          throw std::runtime_error("Identifier too long!");
+        }
+        SetNextToken(Token(Token::TokenType::IDENTIFIER, text), start);
       }
+      return;
     }
-  }
-}
-
-// Tokenizer::CharacterStream
-
-Tokenizer::CharacterStream::CharacterStream(const std::string& filename)
-  : stream_(filename) {
-  GetNextLine();
-}
-
-Tokenizer::CharacterStream::~CharacterStream() {
-  stream_.close();
-}
 
-std::string Tokenizer::CharacterStream::ConsumeStreamThrough(
-  const std::string& sequence) {
-  std::stringstream found;
-  while (HasMoreChars()) {
-    found << GetNextChar();
-    std::string curr_seq = found.str();
-    if (curr_seq.size() >= sequence.size() &&
-        curr_seq.substr(curr_seq.size() - sequence.size()) == sequence) {
-      return curr_seq.substr(0, curr_seq.size() - sequence.size());
-    }
+    throw std::runtime_error(std::string("Unexpected character: ") + c);
   }
-  return found.str();
+  next_token_start_ = position_;
 }
 
-bool Tokenizer::CharacterStream::HasMoreChars() const {
-  return next_line_ != boost::none;
+void Tokenizer::SkipLineComment() {
+  position_ = FindChar(position_, end_, kNewLineChar);
 }
 
-char Tokenizer::CharacterStream::PeekNextChar() const {
-  if (idx_ == next_line_->size()) {
-    return kNewLineChar;
-  }
-  return (*next_line_)[idx_];
-}
-
-char Tokenizer::CharacterStream::GetNextChar() {
-  if (idx_ == next_line_->size()) {
-    UnsetNextLine();
-    GetNextLine();
-    return kNewLineChar;
+void Tokenizer::SkipBlockComment() {
+  const char* end = end_;
+  // Documentation comments put a '*' on every line, so search for the
+  // rarer '/' and check what precedes it. Starting past the opening "/*"
+  // keeps "/*/" from closing itself.
+  const char* body = position_ + 2;
+  const char* slash = body;
+  while ((slash = FindChar(slash, end, kSlashChar)) != end) {
+    if (slash > body && slash[-1] == kStarChar) {
+      CountNewLines(body, slash);
+      position_ = slash + 1;
+      return;
+    }
+    slash++;
   }
-
-  return (*next_line_)[idx_++];
-}
-
-void Tokenizer::CharacterStream::UnsetNextLine() {
-  next_line_ = boost::none;
+  CountNewLines(body, end);
+  position_ = end;
 }
 
-void Tokenizer::CharacterStream::GetNextLine() {
-  std::string line;
-  if (std::getline(stream_, line)) {
-    next_line_ = line;
-    idx_ = 0;
+void Tokenizer::CountNewLines(const char* begin, const char* end) {
+  const char* new_line = begin;
+  while ((new_line = FindChar(new_line, end, kNewLineChar)) != end) {
+    new_line++;
+    line_++;
+    line_start_ = new_line;
   }
 }
@@ -2,37 +2,47 @@
 #define SYNTAX_ANALYZER_TOKENIZER_HPP_
 
 #include <boost/optional.hpp>
-#include <fstream>
+#include <memory>
 #include <string>
-#include <vector>
 
+#include "./source-buffer.hpp"
 #include "./token.hpp"
 
+// Splits a Jack source file into tokens. The file is memory-mapped and
+// scanned in place: characters are classified through a 256-entry table,
+// keywords are recognized through a compile-time perfect hash, and
+// identifier and string tokens are spans into the mapped buffer. The
+// current token is returned by reference and stays valid until Advance().
 class Tokenizer {
   public:
     Tokenizer(const std::string& filename);
-    Token GetNextToken();
+    explicit Tokenizer(std::shared_ptr<const SourceBuffer> source);
+    // Tokenizes [begin, end) of |source|. Line and column numbers are still
+    // counted from the start of |source|.
+    Tokenizer(std::shared_ptr<const SourceBuffer> source,
+              const char* begin, const char* end);
+    const Token& GetNextToken() const;
+    // Where the next token starts in the source buffer.
+    const char* GetNextTokenStart() const;
     bool HasNextToken() const;
     void Advance();
+    // The buffer that tokens point into.
+    std::shared_ptr<const SourceBuffer> GetSource() const;
   private:
-    class CharacterStream {
-     public:
-      CharacterStream(const std::string& filename);
-      ~CharacterStream();
-      char GetNextChar();
-      char PeekNextChar() const;
-      bool HasMoreChars() const;
-      std::string ConsumeStreamThrough(const std::string& sequence);
-     private:
-      void GetNextLine();
-      void UnsetNextLine();
-      std::ifstream stream_;
-      boost::optional<std::string> next_line_;
-      size_t idx_;
-    };
+    void SkipLineComment();
+    void SkipBlockComment();
+    void CountNewLines(const char* begin, const char* end);
+    void SetNextToken(const Token& token, const char* start);
     void UnsetNextToken();
     boost::optional<Token> next_token_;
-    CharacterStream stream_;
+    const char* next_token_start_;
+    std::shared_ptr<const SourceBuffer> source_;
+    const char* position_;
+    const char* end_;
+    // 1-based number of the line containing |position_|, and where that
+    // line starts.
+    size_t line_;
+    const char* line_start_;
 };
 
 #endif
@@ -1,10 +0,0 @@
-#ifndef SYNTAX_ANALYZER_UTIL_HPP_
-#define SYNTAX_ANALYZER_UTIL_HPP_
-
-#include <string>
-
-std::string StartTag(const std::string& value);
-
-std::string EndTag(const std::string& value);
-
-#endif
@@ -0,0 +1,55 @@
+#include "./vm-writer.hpp"
+
+namespace {
+  // Indexed by VMWriter::Segment.
+  constexpr std::string_view kSegmentNames[] = {
+    "constant", "argument", "local", "static", "this", "that", "pointer", "temp"
+  };
+
+  // Indexed by VMWriter::Command.
+  constexpr std::string_view kCommandNames[] = {
+    "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not"
+  };
+
+  std::string_view ToString(VMWriter::Segment segment) {
+    return kSegmentNames[static_cast<size_t>(segment)];
+  }
+}
+
+void VMWriter::WritePush(Segment segment, int index) {
+  out_ << "push " << ToString(segment) << ' ' << index << '\n';
+}
+
+void VMWriter::WritePop(Segment segment, int index) {
+  out_ << "pop " << ToString(segment) << ' ' << index << '\n';
+}
+
+void VMWriter::WriteArithmetic(Command command) {
+  out_ << kCommandNames[static_cast<size_t>(command)] << '\n';
+}
+
+void VMWriter::WriteLabel(std::string_view prefix, int index) {
+  out_ << "label " << prefix << index << '\n';
+}
+
+void VMWriter::WriteGoto(std::string_view prefix, int index) {
+  out_ << "goto " << prefix << index << '\n';
+}
+
+void VMWriter::WriteIf(std::string_view prefix, int index) {
+  out_ << "if-goto " << prefix << index << '\n';
+}
+
+void VMWriter::WriteCall(std::string_view class_name, std::string_view subroutine_name,
+                         int n_args) {
+  out_ << "call " << class_name << '.' << subroutine_name << ' ' << n_args << '\n';
+}
+
+void VMWriter::WriteFunction(std::string_view class_name,
+                             std::string_view subroutine_name, int n_locals) {
+  out_ << "function " << class_name << '.' << subroutine_name << ' ' << n_locals << '\n';
+}
+
+void VMWriter::WriteReturn() {
+  out_ << "return\n";
+}
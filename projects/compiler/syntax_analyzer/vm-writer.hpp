@@ -0,0 +1,54 @@
+#ifndef SYNTAX_ANALYZER_VM_WRITER_HPP_
+#define SYNTAX_ANALYZER_VM_WRITER_HPP_
+
+#include <ostream>
+#include <string_view>
+
+// Writes VM commands, one per line, in the format read by
+// projects/vm_translator.
+class VMWriter {
+ public:
+  enum class Segment {
+    CONSTANT,
+    ARGUMENT,
+    LOCAL,
+    STATIC,
+    THIS,
+    THAT,
+    POINTER,
+    TEMP
+  };
+
+  enum class Command {
+    ADD,
+    SUB,
+    NEG,
+    EQ,
+    GT,
+    LT,
+    AND,
+    OR,
+    NOT
+  };
+
+  explicit VMWriter(std::ostream& out) : out_(out) {}
+
+  void WritePush(Segment segment, int index);
+  void WritePop(Segment segment, int index);
+  void WriteArithmetic(Command command);
+  // Labels are written as |prefix| followed by |index|, e.g. "WHILE_EXP0".
+  void WriteLabel(std::string_view prefix, int index);
+  void WriteGoto(std::string_view prefix, int index);
+  void WriteIf(std::string_view prefix, int index);
+  // Calls |class_name|.|subroutine_name|.
+  void WriteCall(std::string_view class_name, std::string_view subroutine_name,
+                 int n_args);
+  void WriteFunction(std::string_view class_name, std::string_view subroutine_name,
+                     int n_locals);
+  void WriteReturn();
+
+ private:
+  std::ostream& out_;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "./work-stealing-pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+WorkStealingPool::WorkStealingPool(size_t num_threads)
+  : next_queue_(0), queued_tasks_(0), pending_tasks_(0), stopping_(false) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    queues_.emplace_back(new WorkQueue());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&WorkStealingPool::RunWorker, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkStealingPool::Submit(Task task) {
+  WorkQueue& queue = *queues_[next_queue_];
+  next_queue_ = (next_queue_ + 1) % queues_.size();
+  // Counted before it can be taken, so that a worker that finishes it
+  // straight away never brings the counts below zero.
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_tasks_++;
+    pending_tasks_++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  work_available_.notify_one();
+}
+
+void WorkStealingPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  all_done_.wait(lock, [this] { return pending_tasks_ == 0; });
+}
+
+void WorkStealingPool::RunWorker(size_t index) {
+  while (true) {
+    Task task;
+    if (TryPop(index, &task) || TrySteal(index, &task)) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_tasks_--;
+      }
+      task();
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_tasks_ == 0) {
+        all_done_.notify_all();
+      }
+      continue;
+    }
+
+    // |queued_tasks_| is raised just before a task is put in its queue, so
+    // while the count is non-zero a task is in a queue or about to be, and
+    // another pass over the queues will find it.
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_available_.wait(lock, [this] { return stopping_ || queued_tasks_ > 0; });
+    if (stopping_ && queued_tasks_ == 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::TryPop(size_t index, Task* task) {
+  WorkQueue& queue = *queues_[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  *task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::TrySteal(size_t thief, Task* task) {
+  for (size_t offset = 1; offset < queues_.size(); offset++) {
+    WorkQueue& queue = *queues_[(thief + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      *task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
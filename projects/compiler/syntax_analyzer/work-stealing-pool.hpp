@@ -0,0 +1,64 @@
+#ifndef SYNTAX_ANALYZER_WORK_STEALING_POOL_HPP_
+#define SYNTAX_ANALYZER_WORK_STEALING_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool. Every worker has its own task queue: it takes
+// work from the back of its own queue and, when that runs dry, steals from
+// the front of the others'. Tasks must not throw.
+//
+// Usage:
+//   WorkStealingPool pool(4);
+//   for (const auto& file : files) {
+//     pool.Submit([&file] { Compile(file); });
+//   }
+//   pool.Wait();
+class WorkStealingPool {
+ public:
+  typedef std::function<void()> Task;
+
+  // Starts |num_threads| workers; 0 means one per hardware thread.
+  explicit WorkStealingPool(size_t num_threads);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  // Queues |task|. Tasks are dealt round-robin to the workers' queues.
+  void Submit(Task task);
+  // Blocks until every submitted task has finished.
+  void Wait();
+
+ private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void RunWorker(size_t index);
+  bool TryPop(size_t index, Task* task);
+  bool TrySteal(size_t thief, Task* task);
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> workers_;
+  size_t next_queue_;
+
+  // Guards the counters and |stopping_|.
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable all_done_;
+  // Tasks sitting in a queue.
+  size_t queued_tasks_;
+  // Tasks submitted but not yet finished.
+  size_t pending_tasks_;
+  bool stopping_;
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "./xml-printer.hpp"
+
+namespace {
+  constexpr XMLTag kClassXMLTag = { "<class>", "</class>" };
+  constexpr XMLTag kClassVarDeclXMLTag = { "<classVarDec>", "</classVarDec>" };
+  constexpr XMLTag kSubroutineXMLTag = { "<subroutineDec>", "</subroutineDec>" };
+  constexpr XMLTag kParamListXMLTag = { "<parameterList>", "</parameterList>" };
+  constexpr XMLTag kSubroutineBodyXMLTag = { "<subroutineBody>", "</subroutineBody>" };
+  constexpr XMLTag kVarDeclXMLTag = { "<varDec>", "</varDec>" };
+  constexpr XMLTag kStatementsXMLTag = { "<statements>", "</statements>" };
+  constexpr XMLTag kIfStatementXMLTag = { "<ifStatement>", "</ifStatement>" };
+  constexpr XMLTag kWhileStatementXMLTag = { "<whileStatement>", "</whileStatement>" };
+  constexpr XMLTag kDoStatementXMLTag = { "<doStatement>", "</doStatement>" };
+  constexpr XMLTag kReturnStatementXMLTag = { "<returnStatement>", "</returnStatement>" };
+  constexpr XMLTag kLetStatementXMLTag = { "<LetStatement>", "</LetStatement>" };
+  constexpr XMLTag kExpressionXMLTag = { "<expression>", "</expression>" };
+  constexpr XMLTag kExpressionListXMLTag = { "<expressionList>", "</expressionList>" };
+  constexpr XMLTag kTermXMLTag = { "<term>", "</term>" };
+}
+
+void XMLPrinter::PrintClass(const ClassNode& node) {
+  writer_->StartElement(kClassXMLTag);
+  PrintKeyword(Token::Keyword::CLASS);
+  PrintToken(node.name);
+  PrintSymbol('{');
+  for (const VarDecNode* var_dec : node.var_decs) {
+    PrintVarDec(*var_dec, kClassVarDeclXMLTag);
+  }
+  for (const SubroutineDecNode* subroutine : node.subroutines) {
+    PrintSubroutineDec(*subroutine);
+  }
+  PrintSymbol('}');
+  writer_->EndElement(kClassXMLTag);
+}
+
+void XMLPrinter::PrintVarDec(const VarDecNode& node, const XMLTag& tag) {
+  writer_->StartElement(tag);
+  PrintToken(node.keyword);
+  PrintToken(node.type);
+  for (size_t i = 0; i < node.names.size(); i++) {
+    if (i > 0) {
+      PrintSymbol(',');
+    }
+    PrintToken(node.names[i]);
+  }
+  PrintSymbol(';');
+  writer_->EndElement(tag);
+}
+
+void XMLPrinter::PrintSubroutineDec(const SubroutineDecNode& node) {
+  writer_->StartElement(kSubroutineXMLTag);
+  PrintToken(node.keyword);
+  PrintToken(node.return_type);
+  PrintToken(node.name);
+  PrintSymbol('(');
+  writer_->StartElement(kParamListXMLTag);
+  for (size_t i = 0; i < node.parameters.size(); i++) {
+    if (i > 0) {
+      PrintSymbol(',');
+    }
+    PrintToken(node.parameters[i].type);
+    PrintToken(node.parameters[i].name);
+  }
+  writer_->EndElement(kParamListXMLTag);
+  PrintSymbol(')');
+  PrintSubroutineBody(*node.body);
+  writer_->EndElement(kSubroutineXMLTag);
+}
+
+void XMLPrinter::PrintSubroutineBody(const SubroutineBodyNode& node) {
+  writer_->StartElement(kSubroutineBodyXMLTag);
+  PrintSymbol('{');
+  for (const VarDecNode* var_dec : node.var_decs) {
+    PrintVarDec(*var_dec, kVarDeclXMLTag);
+  }
+  PrintStatements(node.statements);
+  PrintSymbol('}');
+  writer_->EndElement(kSubroutineBodyXMLTag);
+}
+
+void XMLPrinter::PrintStatements(const ArenaArray<StatementNode*>& statements) {
+  writer_->StartElement(kStatementsXMLTag);
+  for (const StatementNode* statement : statements) {
+    PrintStatement(*statement);
+  }
+  writer_->EndElement(kStatementsXMLTag);
+}
+
+void XMLPrinter::PrintStatement(const StatementNode& node) {
+  switch (node.type) {
+    case StatementNode::StatementType::LET:
+      writer_->StartElement(kLetStatementXMLTag);
+      PrintToken(node.keyword);
+      PrintToken(node.var_name);
+      if (node.index != nullptr) {
+        PrintSymbol('[');
+        PrintExpression(*node.index);
+        PrintSymbol(']');
+      }
+      PrintSymbol('=');
+      PrintExpression(*node.expression);
+      PrintSymbol(';');
+      writer_->EndElement(kLetStatementXMLTag);
+      break;
+    case StatementNode::StatementType::IF:
+      writer_->StartElement(kIfStatementXMLTag);
+      PrintToken(node.keyword);
+      PrintSymbol('(');
+      PrintExpression(*node.expression);
+      PrintSymbol(')');
+      PrintSymbol('{');
+      PrintStatements(node.statements);
+      PrintSymbol('}');
+      if (node.has_else) {
+        PrintKeyword(Token::Keyword::ELSE);
+        PrintSymbol('{');
+        PrintStatements(node.else_statements);
+        PrintSymbol('}');
+      }
+      writer_->EndElement(kIfStatementXMLTag);
+      break;
+    case StatementNode::StatementType::WHILE:
+      writer_->StartElement(kWhileStatementXMLTag);
+      PrintToken(node.keyword);
+      PrintSymbol('(');
+      PrintExpression(*node.expression);
+      PrintSymbol(')');
+      PrintSymbol('{');
+      PrintStatements(node.statements);
+      PrintSymbol('}');
+      writer_->EndElement(kWhileStatementXMLTag);
+      break;
+    case StatementNode::StatementType::DO:
+      writer_->StartElement(kDoStatementXMLTag);
+      PrintToken(node.keyword);
+      PrintSubroutineCall(*node.call);
+      PrintSymbol(';');
+      writer_->EndElement(kDoStatementXMLTag);
+      break;
+    case StatementNode::StatementType::RETURN:
+      writer_->StartElement(kReturnStatementXMLTag);
+      PrintToken(node.keyword);
+      if (node.expression != nullptr) {
+        PrintExpression(*node.expression);
+      }
+      PrintSymbol(';');
+      writer_->EndElement(kReturnStatementXMLTag);
+      break;
+  }
+}
+
+void XMLPrinter::PrintExpression(const ExpressionNode& node) {
+  writer_->StartElement(kExpressionXMLTag);
+  PrintTerm(*node.first);
+  for (const OperationNode& operation : node.operations) {
+    PrintToken(operation.op);
+    PrintTerm(*operation.term);
+  }
+  writer_->EndElement(kExpressionXMLTag);
+}
+
+void XMLPrinter::PrintTerm(const TermNode& node) {
+  writer_->StartElement(kTermXMLTag);
+  switch (node.type) {
+    case TermNode::TermType::INT_CONSTANT:
+    case TermNode::TermType::STRING_CONSTANT:
+    case TermNode::TermType::KEYWORD_CONSTANT:
+    case TermNode::TermType::VARIABLE:
+      PrintToken(node.token);
+      break;
+    case TermNode::TermType::ARRAY_ELEMENT:
+      PrintToken(node.token);
+      PrintSymbol('[');
+      PrintExpression(*node.expression);
+      PrintSymbol(']');
+      break;
+    case TermNode::TermType::SUBROUTINE_CALL:
+      PrintSubroutineCall(*node.call);
+      break;
+    case TermNode::TermType::PARENTHESIZED:
+      PrintSymbol('(');
+      PrintExpression(*node.expression);
+      PrintSymbol(')');
+      break;
+    case TermNode::TermType::UNARY_OP:
+      PrintToken(node.token);
+      PrintTerm(*node.operand);
+      break;
+  }
+  writer_->EndElement(kTermXMLTag);
+}
+
+void XMLPrinter::PrintSubroutineCall(const SubroutineCallNode& node) {
+  if (node.has_receiver) {
+    PrintToken(node.receiver);
+    PrintSymbol('.');
+  }
+  PrintToken(node.name);
+  PrintSymbol('(');
+  PrintExpressionList(node.arguments);
+  PrintSymbol(')');
+}
+
+void XMLPrinter::PrintExpressionList(const ArenaArray<ExpressionNode*>& expressions) {
+  writer_->StartElement(kExpressionListXMLTag);
+  for (size_t i = 0; i < expressions.size(); i++) {
+    if (i > 0) {
+      PrintSymbol(',');
+    }
+    PrintExpression(*expressions[i]);
+  }
+  writer_->EndElement(kExpressionListXMLTag);
+}
+
+void XMLPrinter::PrintToken(const Token& token) {
+  writer_->WriteToken(token);
+}
+
+void XMLPrinter::PrintSymbol(char symbol) {
+  PrintToken(Token(Token::TokenType::SYMBOL, symbol));
+}
+
+void XMLPrinter::PrintKeyword(Token::Keyword keyword) {
+  PrintToken(Token(Token::TokenType::KEYWORD, keyword));
+}
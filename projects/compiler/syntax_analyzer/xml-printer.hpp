@@ -0,0 +1,32 @@
+#ifndef SYNTAX_ANALYZER_XML_PRINTER_HPP_
+#define SYNTAX_ANALYZER_XML_PRINTER_HPP_
+
+#include "./ast.hpp"
+#include "./xml-writer.hpp"
+
+// Renders a parsed class as the nand2tetris project 10 XML parse tree, one
+// tag or token per line. Punctuation that the tree does not keep is
+// re-emitted where the grammar requires it.
+class XMLPrinter {
+ public:
+  explicit XMLPrinter(XMLWriter* writer) : writer_(writer) {}
+  void PrintClass(const ClassNode& node);
+
+ private:
+  void PrintVarDec(const VarDecNode& node, const XMLTag& tag);
+  void PrintSubroutineDec(const SubroutineDecNode& node);
+  void PrintSubroutineBody(const SubroutineBodyNode& node);
+  void PrintStatements(const ArenaArray<StatementNode*>& statements);
+  void PrintStatement(const StatementNode& node);
+  void PrintExpression(const ExpressionNode& node);
+  void PrintTerm(const TermNode& node);
+  void PrintSubroutineCall(const SubroutineCallNode& node);
+  void PrintExpressionList(const ArenaArray<ExpressionNode*>& expressions);
+  void PrintToken(const Token& token);
+  void PrintSymbol(char symbol);
+  void PrintKeyword(Token::Keyword keyword);
+
+  XMLWriter* writer_;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "./xml-writer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+  constexpr char kNewLine = '\n';
+  constexpr size_t kIndentationWidth = 2;
+  constexpr std::string_view kIndentation =
+    "                                                                ";
+
+  constexpr XMLTag kKeywordTag = { "<keyword> ", " </keyword>" };
+  constexpr XMLTag kSymbolTag = { "<symbol> ", " </symbol>" };
+  constexpr XMLTag kIdentifierTag = { "<identifier> ", " </identifier>" };
+  constexpr XMLTag kIntConstantTag = { "<integerConstant> ", " </integerConstant>" };
+  constexpr XMLTag kStringConstantTag = { "<stringConstant> ", " </stringConstant>" };
+
+  constexpr char kSymbolChars[] = "{}()[].,;+-*/&|<>=~";
+
+  std::string_view EscapeSymbol(char symbol) {
+    switch (symbol) {
+      case '<':
+        return "&lt;";
+      case '>':
+        return "&gt;";
+      case '"':
+        return "&quot;";
+      case '&':
+        return "&amp;";
+      default:
+        return std::string_view(std::strchr(kSymbolChars, symbol), 1);
+    }
+  }
+}
+
+XMLWriter::~XMLWriter() {
+  Flush();
+}
+
+void XMLWriter::StartElement(const XMLTag& tag) {
+  WriteIndentation();
+  Write(tag.start);
+  Write(std::string_view(&kNewLine, 1));
+  depth_++;
+}
+
+void XMLWriter::EndElement(const XMLTag& tag) {
+  depth_--;
+  WriteIndentation();
+  Write(tag.end);
+  Write(std::string_view(&kNewLine, 1));
+}
+
+void XMLWriter::WriteToken(const Token& token) {
+  WriteIndentation();
+  char digits[8];
+  switch (token.GetType()) {
+    case Token::TokenType::KEYWORD:
+      Write(kKeywordTag.start);
+      Write(Token::KeywordToString(token.GetKeyword()));
+      Write(kKeywordTag.end);
+      break;
+    case Token::TokenType::SYMBOL:
+      Write(kSymbolTag.start);
+      Write(EscapeSymbol(token.GetSymbol()));
+      Write(kSymbolTag.end);
+      break;
+    case Token::TokenType::IDENTIFIER:
+      Write(kIdentifierTag.start);
+      Write(token.GetIdentifier());
+      Write(kIdentifierTag.end);
+      break;
+    case Token::TokenType::CONST_INT:
+      Write(kIntConstantTag.start);
+      Write(std::string_view(digits, std::snprintf(digits, sizeof(digits), "%d",
+                                                   token.GetIntConstant())));
+      Write(kIntConstantTag.end);
+      break;
+    case Token::TokenType::CONST_STRING:
+      Write(kStringConstantTag.start);
+      Write(token.GetStringConstant());
+      Write(kStringConstantTag.end);
+      break;
+    case Token::TokenType::TOKEN_TYPE_UNSPECIFIED:
+      throw TokenTypeException();
+  }
+  Write(std::string_view(&kNewLine, 1));
+}
+
+void XMLWriter::Flush() {
+  out_.write(buffer_.data(), size_);
+  size_ = 0;
+}
+
+void XMLWriter::Write(std::string_view text) {
+  if (text.size() > kBufferSize - size_) {
+    Flush();
+    if (text.size() > kBufferSize) {
+      out_.write(text.data(), text.size());
+      return;
+    }
+  }
+  std::memcpy(buffer_.data() + size_, text.data(), text.size());
+  size_ += text.size();
+}
+
+void XMLWriter::WriteIndentation() {
+  size_t width = depth_ * kIndentationWidth;
+  while (width > 0) {
+    size_t chunk = std::min(width, kIndentation.size());
+    Write(kIndentation.substr(0, chunk));
+    width -= chunk;
+  }
+}
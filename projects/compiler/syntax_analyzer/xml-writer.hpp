@@ -0,0 +1,47 @@
+#ifndef SYNTAX_ANALYZER_XML_WRITER_HPP_
+#define SYNTAX_ANALYZER_XML_WRITER_HPP_
+
+#include <array>
+#include <ostream>
+#include <string_view>
+
+#include "./token.hpp"
+
+// An element name with its start and end tags spelled out, so that writing
+// a tag is a plain copy.
+struct XMLTag {
+  std::string_view start;
+  std::string_view end;
+};
+
+// Buffered, indenting writer for the project 10 XML format. Output is
+// collected in a fixed-size buffer and handed to |out| in large chunks, so
+// memory use does not depend on the size of the document.
+class XMLWriter {
+ public:
+  explicit XMLWriter(std::ostream& out) : out_(out), size_(0), depth_(0) {}
+  ~XMLWriter();
+
+  XMLWriter(const XMLWriter&) = delete;
+  XMLWriter& operator=(const XMLWriter&) = delete;
+
+  // Writes the start tag of |tag| on its own line and indents what follows.
+  void StartElement(const XMLTag& tag);
+  void EndElement(const XMLTag& tag);
+  // Writes |token| as a single element, e.g. "<symbol> &lt; </symbol>".
+  void WriteToken(const Token& token);
+  void Flush();
+
+ private:
+  static constexpr size_t kBufferSize = 1 << 16;
+
+  void Write(std::string_view text);
+  void WriteIndentation();
+
+  std::ostream& out_;
+  std::array<char, kBufferSize> buffer_;
+  size_t size_;
+  size_t depth_;
+};
+
+#endif
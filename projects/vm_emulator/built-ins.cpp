@@ -0,0 +1,886 @@
+#include "./built-ins.hpp"
+
+namespace {
+  constexpr uint16_t kAddressMask = 0x7fff;
+  constexpr uint16_t kTempAddress = 5;
+  constexpr int16_t kTrue = -1;
+  constexpr int16_t kFalse = 0;
+  // Loops that the VM code would run forever on a corrupted heap give up
+  // after this many iterations.
+  constexpr int kMaxIterations = 32768;
+
+  constexpr uint16_t kKeyboardAddress = 24576;
+  constexpr int16_t kNewLine = 128;
+  constexpr int16_t kBackSpace = 129;
+  constexpr int16_t kDoubleQuote = 34;
+
+  // The statics of the OS classes, by their index in the compiled code.
+  constexpr int kMathTwoToThe = 0;
+  constexpr int kMathDivisors = 1;
+  constexpr int kMemoryBase = 0;
+  constexpr int kScreenBits = 0;
+  constexpr int kScreenBase = 1;
+  constexpr int kScreenColor = 2;
+  constexpr int kOutputColumn = 0;
+  constexpr int kOutputCursor = 1;
+  constexpr int kOutputLeftHalf = 2;
+  constexpr int kOutputIntBuffer = 3;
+  constexpr int kOutputScreenBase = 4;
+  constexpr int kOutputCharMaps = 5;
+  constexpr int kOutputShiftedMaps = 6;
+
+  // The fields of a String.
+  constexpr int kStringMaxLength = 0;
+  constexpr int kStringChars = 1;
+  constexpr int kStringLength = 2;
+
+  // Jack arithmetic, which wraps at 16 bits.
+  int16_t Add(int16_t x, int16_t y) {
+    return static_cast<int16_t>(x + y);
+  }
+
+  int16_t Sub(int16_t x, int16_t y) {
+    return static_cast<int16_t>(x - y);
+  }
+
+  int16_t Neg(int16_t x) {
+    return static_cast<int16_t>(-x);
+  }
+
+  int16_t Not(int16_t x) {
+    return static_cast<int16_t>(~x);
+  }
+
+  int16_t Bool(bool b) {
+    return b ? kTrue : kFalse;
+  }
+
+  constexpr uint64_t kHashBasis = 14695981039346656037ULL;
+  constexpr uint64_t kHashPrime = 1099511628211ULL;
+
+  uint64_t HashValue(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      hash = (hash ^ ((value >> (8 * i)) & 0xff)) * kHashPrime;
+    }
+    return hash;
+  }
+
+  uint64_t HashString(uint64_t hash, const std::string& text) {
+    for (char c : text) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * kHashPrime;
+    }
+    // Keeps "ab" "c" apart from "a" "bc".
+    return HashValue(hash, text.size());
+  }
+
+  // FNV-1a over every part of every instruction.
+  uint64_t HashInstructions(const VMInstructionSet& instructions) {
+    uint64_t hash = kHashBasis;
+    for (const auto& instruction : instructions) {
+      hash = HashValue(hash, static_cast<uint64_t>(instruction.GetInstructionType()));
+      hash = HashValue(hash, static_cast<uint64_t>(
+        instruction.GetMemorySegmentType().value_or(
+          VMInstruction::MemorySegmentType::TYPE_UNSPECIFIED)));
+      hash = HashValue(hash, instruction.GetMemorySegmentAddress().value_or(0));
+      hash = HashString(hash, instruction.GetLabel().value_or(""));
+      hash = HashString(hash, instruction.GetFunctionName().value_or(""));
+      hash = HashValue(hash, instruction.GetNArgs().value_or(0));
+    }
+    return hash;
+  }
+}
+
+BuiltIns::BuiltIns(uint16_t* ram) :
+  ram_(ram), math_statics_(0), memory_statics_(0), screen_statics_(0), output_statics_(0) {}
+
+const BuiltIns::Function* BuiltIns::Find(const std::string& function_name) {
+  static const std::map<std::string, Function> kFunctions = {
+    { "Math.abs", { [](BuiltIns& b, const int16_t* a) { return b.MathAbs(a[0]); }, 1 } },
+    { "Math.multiply",
+      { [](BuiltIns& b, const int16_t* a) { return b.MathMultiply(a[0], a[1]); }, 2 } },
+    { "Math.divide",
+      { [](BuiltIns& b, const int16_t* a) { return b.MathDivide(a[0], a[1]); }, 2 } },
+    { "Math.sqrt", { [](BuiltIns& b, const int16_t* a) { return b.MathSqrt(a[0]); }, 1 } },
+    { "Math.max", { [](BuiltIns& b, const int16_t* a) { return b.MathMax(a[0], a[1]); }, 2 } },
+    { "Math.min", { [](BuiltIns& b, const int16_t* a) { return b.MathMin(a[0], a[1]); }, 2 } },
+
+    { "Memory.peek", { [](BuiltIns& b, const int16_t* a) { return b.MemoryPeek(a[0]); }, 1 } },
+    { "Memory.poke",
+      { [](BuiltIns& b, const int16_t* a) { return b.MemoryPoke(a[0], a[1]); }, 2 } },
+    { "Memory.alloc", { [](BuiltIns& b, const int16_t* a) { return b.MemoryAlloc(a[0]); }, 1 } },
+    { "Memory.deAlloc",
+      { [](BuiltIns& b, const int16_t* a) { return b.MemoryDeAlloc(a[0]); }, 1 } },
+
+    { "Array.new", { [](BuiltIns& b, const int16_t* a) { return b.ArrayNew(a[0]); }, 1 } },
+    { "Array.dispose",
+      { [](BuiltIns& b, const int16_t* a) { return b.ArrayDispose(a[0]); }, 1 } },
+
+    { "String.new", { [](BuiltIns& b, const int16_t* a) { return b.StringNew(a[0]); }, 1 } },
+    { "String.dispose",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringDispose(a[0]); }, 1 } },
+    { "String.length",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringLength(a[0]); }, 1 } },
+    { "String.charAt",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringCharAt(a[0], a[1]); }, 2 } },
+    { "String.setCharAt",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringSetCharAt(a[0], a[1], a[2]); }, 3 } },
+    { "String.appendChar",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringAppendChar(a[0], a[1]); }, 2 } },
+    { "String.eraseLastChar",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringEraseLastChar(a[0]); }, 1 } },
+    { "String.intValue",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringIntValue(a[0]); }, 1 } },
+    { "String.setInt",
+      { [](BuiltIns& b, const int16_t* a) { return b.StringSetInt(a[0], a[1]); }, 2 } },
+    { "String.newLine", { [](BuiltIns&, const int16_t*) { return kNewLine; }, 0 } },
+    { "String.backSpace", { [](BuiltIns&, const int16_t*) { return kBackSpace; }, 0 } },
+    { "String.doubleQuote", { [](BuiltIns&, const int16_t*) { return kDoubleQuote; }, 0 } },
+
+    { "Screen.clearScreen",
+      { [](BuiltIns& b, const int16_t*) { return b.ScreenClearScreen(); }, 0 } },
+    { "Screen.updateLocation",
+      { [](BuiltIns& b, const int16_t* a) { return b.ScreenUpdateLocation(a[0], a[1]); }, 2 } },
+    { "Screen.setColor",
+      { [](BuiltIns& b, const int16_t* a) { return b.ScreenSetColor(a[0]); }, 1 } },
+    { "Screen.drawPixel",
+      { [](BuiltIns& b, const int16_t* a) { return b.ScreenDrawPixel(a[0], a[1]); }, 2 } },
+    { "Screen.drawConditional",
+      { [](BuiltIns& b, const int16_t* a) {
+          return b.ScreenDrawConditional(a[0], a[1], a[2]);
+        }, 3 } },
+    { "Screen.drawLine",
+      { [](BuiltIns& b, const int16_t* a) {
+          return b.ScreenDrawLine(a[0], a[1], a[2], a[3]);
+        }, 4 } },
+    { "Screen.drawRectangle",
+      { [](BuiltIns& b, const int16_t* a) {
+          return b.ScreenDrawRectangle(a[0], a[1], a[2], a[3]);
+        }, 4 } },
+    { "Screen.drawHorizontal",
+      { [](BuiltIns& b, const int16_t* a) {
+          return b.ScreenDrawHorizontal(a[0], a[1], a[2]);
+        }, 3 } },
+    { "Screen.drawSymetric",
+      { [](BuiltIns& b, const int16_t* a) {
+          return b.ScreenDrawSymetric(a[0], a[1], a[2], a[3]);
+        }, 4 } },
+    { "Screen.drawCircle",
+      { [](BuiltIns& b, const int16_t* a) { return b.ScreenDrawCircle(a[0], a[1], a[2]); }, 3 } },
+
+    { "Output.getMap", { [](BuiltIns& b, const int16_t* a) { return b.OutputGetMap(a[0]); }, 1 } },
+    { "Output.drawChar",
+      { [](BuiltIns& b, const int16_t* a) { return b.OutputDrawChar(a[0]); }, 1 } },
+    { "Output.moveCursor",
+      { [](BuiltIns& b, const int16_t* a) { return b.OutputMoveCursor(a[0], a[1]); }, 2 } },
+    { "Output.printChar",
+      { [](BuiltIns& b, const int16_t* a) { return b.OutputPrintChar(a[0]); }, 1 } },
+    { "Output.printString",
+      { [](BuiltIns& b, const int16_t* a) { return b.OutputPrintString(a[0]); }, 1 } },
+    { "Output.printInt",
+      { [](BuiltIns& b, const int16_t* a) { return b.OutputPrintInt(a[0]); }, 1 } },
+    { "Output.println", { [](BuiltIns& b, const int16_t*) { return b.OutputPrintln(); }, 0 } },
+    { "Output.backSpace",
+      { [](BuiltIns& b, const int16_t*) { return b.OutputBackSpace(); }, 0 } },
+
+    { "Keyboard.keyPressed",
+      { [](BuiltIns& b, const int16_t*) { return b.KeyboardKeyPressed(); }, 0 } },
+    { "Sys.wait", { [](BuiltIns& b, const int16_t* a) { return b.SysWait(a[0]); }, 1 } },
+  };
+  auto function = kFunctions.find(function_name);
+  return function == kFunctions.end() ? nullptr : &function->second;
+}
+
+std::vector<std::string> BuiltIns::GetDependencies(const std::string& class_name) {
+  static const std::map<std::string, std::vector<std::string>> kDependencies = {
+    { "Math", { "Math" } },
+    { "Memory", { "Memory" } },
+    { "Array", { "Array", "Memory" } },
+    { "String", { "String", "Array", "Memory", "Math" } },
+    { "Screen", { "Screen", "Math" } },
+    { "Output", { "Output", "String", "Array", "Memory", "Math" } },
+    { "Keyboard", { "Keyboard", "Memory" } },
+    { "Sys", { "Sys" } },
+  };
+  auto dependencies = kDependencies.find(class_name);
+  return dependencies == kDependencies.end() ?
+    std::vector<std::string>() : dependencies->second;
+}
+
+bool BuiltIns::IsStockClass(const std::string& class_name,
+                            const VMInstructionSet& instructions) {
+  // The hashes of the files in tools/OS.
+  static const std::map<std::string, uint64_t> kStockHashes = {
+    { "Array", 0x937fb3149dbdec54ULL },
+    { "Keyboard", 0xf87206e981dbd4a7ULL },
+    { "Math", 0xe6c70a80cb28d2e6ULL },
+    { "Memory", 0xdf35fb38080ada70ULL },
+    { "Output", 0x9c17018c5f56ad04ULL },
+    { "Screen", 0x55d65a749f93f938ULL },
+    { "String", 0x4952ae379ca4867eULL },
+    { "Sys", 0xca7f434820c71be0ULL },
+  };
+  auto stock_hash = kStockHashes.find(class_name);
+  return stock_hash != kStockHashes.end() &&
+         stock_hash->second == HashInstructions(instructions);
+}
+
+void BuiltIns::SetStaticBase(const std::string& class_name, uint16_t base) {
+  if (class_name == "Math") {
+    math_statics_ = base;
+  } else if (class_name == "Memory") {
+    memory_statics_ = base;
+  } else if (class_name == "Screen") {
+    screen_statics_ = base;
+  } else if (class_name == "Output") {
+    output_statics_ = base;
+  }
+}
+
+bool BuiltIns::Call(const Function& function, const int16_t* args, int16_t* result) {
+  journal_.clear();
+  try {
+    *result = function.run(*this, args);
+    return true;
+  } catch (const Declined&) {
+    for (auto write = journal_.rbegin(); write != journal_.rend(); write++) {
+      ram_[write->first] = write->second;
+    }
+    return false;
+  }
+}
+
+uint16_t BuiltIns::Read(int16_t address) const {
+  return ram_[static_cast<uint16_t>(address) & kAddressMask];
+}
+
+void BuiltIns::Write(int16_t address, int16_t value) {
+  uint16_t masked = static_cast<uint16_t>(address) & kAddressMask;
+  journal_.emplace_back(masked, ram_[masked]);
+  ram_[masked] = static_cast<uint16_t>(value);
+}
+
+int16_t BuiltIns::Static(uint16_t base, int index) const {
+  return static_cast<int16_t>(Read(static_cast<int16_t>(base + index)));
+}
+
+void BuiltIns::SetStatic(uint16_t base, int index, int16_t value) {
+  Write(static_cast<int16_t>(base + index), value);
+}
+
+void BuiltIns::Store(int16_t address, int16_t value) {
+  Write(kTempAddress, value);
+  Write(address, value);
+}
+
+void BuiltIns::Discard(int16_t value) {
+  Write(kTempAddress, value);
+}
+
+int16_t BuiltIns::MathAbs(int16_t x) {
+  return x < 0 ? Neg(x) : x;
+}
+
+int16_t BuiltIns::MathMultiply(int16_t x, int16_t y) {
+  int16_t sum = 0;
+  int16_t covered = 0;
+  int16_t j = 0;
+  bool negative = (x < 0 && y > 0) || (x > 0 && y < 0);
+  x = MathAbs(x);
+  y = MathAbs(y);
+  if (x < y) {
+    std::swap(x, y);
+  }
+  // Adds x shifted by each bit of y until the bits added make up y.
+  for (int i = 0; Sub(covered, 1) < Sub(y, 1); i++) {
+    if (i == kMaxIterations) {
+      throw Declined();
+    }
+    int16_t bit = static_cast<int16_t>(Read(Add(j, Static(math_statics_, kMathTwoToThe))));
+    if ((bit & y) != 0) {
+      sum = Add(sum, x);
+      covered = Add(covered, bit);
+    }
+    x = Add(x, x);
+    j = Add(j, 1);
+  }
+  return negative ? Neg(sum) : sum;
+}
+
+int16_t BuiltIns::MathDivide(int16_t x, int16_t y) {
+  if (y == 0) {
+    throw Declined();
+  }
+  int16_t divisors = Static(math_statics_, kMathDivisors);
+  auto divisor = [this, divisors](int16_t i) {
+    return static_cast<int16_t>(Read(Add(i, divisors)));
+  };
+  int16_t i = 0;
+  int16_t quotient = 0;
+  bool negative = (x < 0 && y > 0) || (x > 0 && y < 0);
+  bool done = false;
+  Store(divisors, MathAbs(y));
+  x = MathAbs(x);
+  // Doubles y until it would overflow or pass x, then subtracts the
+  // doublings from x from the largest down.
+  while (i < 15 && !done) {
+    done = Sub(32767, Sub(divisor(i), 1)) < Sub(divisor(i), 1);
+    if (!done) {
+      Store(Add(Add(i, 1), divisors), Add(divisor(i), divisor(i)));
+      done = Sub(divisor(Add(i, 1)), 1) > Sub(x, 1);
+      if (!done) {
+        i = Add(i, 1);
+      }
+    }
+  }
+  while (i > -1) {
+    if (!(Sub(divisor(i), 1) > Sub(x, 1))) {
+      quotient = Add(quotient, static_cast<int16_t>(
+        Read(Add(i, Static(math_statics_, kMathTwoToThe)))));
+      x = Sub(x, divisor(i));
+    }
+    i = Sub(i, 1);
+  }
+  return negative ? Neg(quotient) : quotient;
+}
+
+int16_t BuiltIns::MathSqrt(int16_t x) {
+  if (x < 0) {
+    throw Declined();
+  }
+  int16_t y = 0;
+  for (int16_t j = 7; j > -1; j = Sub(j, 1)) {
+    int16_t guess = Add(y, static_cast<int16_t>(
+      Read(Add(j, Static(math_statics_, kMathTwoToThe)))));
+    int16_t square = MathMultiply(guess, guess);
+    if (!(square > x) && !(square < 0)) {
+      y = guess;
+    }
+  }
+  return y;
+}
+
+int16_t BuiltIns::MathMax(int16_t a, int16_t b) {
+  return a > b ? a : b;
+}
+
+int16_t BuiltIns::MathMin(int16_t a, int16_t b) {
+  return a < b ? a : b;
+}
+
+int16_t BuiltIns::MemoryPeek(int16_t address) {
+  address = Add(address, Static(memory_statics_, kMemoryBase));
+  // The VM code reaches memory through the that pointer, which reads the
+  // callee's own registers there.
+  if ((static_cast<uint16_t>(address) & kAddressMask) <= kTempAddress - 1) {
+    throw Declined();
+  }
+  return static_cast<int16_t>(Read(address));
+}
+
+int16_t BuiltIns::MemoryPoke(int16_t address, int16_t value) {
+  address = Add(address, Static(memory_statics_, kMemoryBase));
+  if ((static_cast<uint16_t>(address) & kAddressMask) <= kTempAddress - 1) {
+    throw Declined();
+  }
+  Store(address, value);
+  return 0;
+}
+
+int16_t BuiltIns::MemoryAlloc(int16_t size) {
+  if (size < 1) {
+    throw Declined();
+  }
+  auto word = [this](int16_t address) {
+    return static_cast<int16_t>(Read(address));
+  };
+  // First fit: each free block holds its size and the next free block.
+  int16_t block = 2048;
+  for (int i = 0; word(block) < size; i++) {
+    if (i == kMaxIterations) {
+      throw Declined();
+    }
+    block = word(Add(1, block));
+  }
+  if (Add(block, size) > 16379) {
+    throw Declined();
+  }
+  if (word(block) > Add(size, 2)) {
+    Store(Add(Add(size, 2), block), Sub(Sub(word(block), size), 2));
+    if (word(Add(1, block)) == Add(block, 2)) {
+      Store(Add(Add(size, 3), block), Add(Add(block, size), 4));
+    } else {
+      Store(Add(Add(size, 3), block), word(Add(1, block)));
+    }
+    Store(Add(1, block), Add(Add(block, size), 2));
+  }
+  Store(block, 0);
+  return Add(block, 2);
+}
+
+int16_t BuiltIns::MemoryDeAlloc(int16_t object) {
+  auto word = [this](int16_t address) {
+    return static_cast<int16_t>(Read(address));
+  };
+  int16_t segment = Sub(object, 2);
+  int16_t next = word(Add(1, segment));
+  if (word(next) == 0) {
+    Store(segment, Sub(Sub(word(Add(1, segment)), segment), 2));
+  } else {
+    Store(segment, Add(Sub(word(Add(1, segment)), segment), word(next)));
+    if (word(Add(1, next)) == Add(next, 2)) {
+      Store(Add(1, segment), Add(segment, 2));
+    } else {
+      Store(Add(1, segment), word(Add(1, next)));
+    }
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ArrayNew(int16_t size) {
+  if (!(size > 0)) {
+    throw Declined();
+  }
+  return MemoryAlloc(size);
+}
+
+int16_t BuiltIns::ArrayDispose(int16_t array) {
+  Discard(MemoryDeAlloc(array));
+  return 0;
+}
+
+int16_t BuiltIns::StringNew(int16_t max_length) {
+  if (max_length < 0) {
+    throw Declined();
+  }
+  int16_t string = MemoryAlloc(3);
+  if (max_length > 0) {
+    Write(Add(string, kStringChars), ArrayNew(max_length));
+  }
+  Write(Add(string, kStringMaxLength), max_length);
+  Write(Add(string, kStringLength), 0);
+  return string;
+}
+
+int16_t BuiltIns::StringDispose(int16_t string) {
+  if (static_cast<int16_t>(Read(Add(string, kStringMaxLength))) > 0) {
+    Discard(ArrayDispose(static_cast<int16_t>(Read(Add(string, kStringChars)))));
+  }
+  Discard(MemoryDeAlloc(string));
+  return 0;
+}
+
+int16_t BuiltIns::StringLength(int16_t string) {
+  return static_cast<int16_t>(Read(Add(string, kStringLength)));
+}
+
+int16_t BuiltIns::StringCharAt(int16_t string, int16_t j) {
+  int16_t length = StringLength(string);
+  if (j < 0 || j > length || j == length) {
+    throw Declined();
+  }
+  return static_cast<int16_t>(Read(Add(j, static_cast<int16_t>(
+    Read(Add(string, kStringChars))))));
+}
+
+int16_t BuiltIns::StringSetCharAt(int16_t string, int16_t j, int16_t c) {
+  int16_t length = StringLength(string);
+  if (j < 0 || j > length || j == length) {
+    throw Declined();
+  }
+  Store(Add(j, static_cast<int16_t>(Read(Add(string, kStringChars)))), c);
+  return 0;
+}
+
+int16_t BuiltIns::StringAppendChar(int16_t string, int16_t c) {
+  int16_t length = StringLength(string);
+  if (length == static_cast<int16_t>(Read(Add(string, kStringMaxLength)))) {
+    throw Declined();
+  }
+  Store(Add(length, static_cast<int16_t>(Read(Add(string, kStringChars)))), c);
+  Write(Add(string, kStringLength), Add(length, 1));
+  return string;
+}
+
+int16_t BuiltIns::StringEraseLastChar(int16_t string) {
+  int16_t length = StringLength(string);
+  if (length == 0) {
+    throw Declined();
+  }
+  Write(Add(string, kStringLength), Sub(length, 1));
+  return 0;
+}
+
+int16_t BuiltIns::StringIntValue(int16_t string) {
+  if (StringLength(string) == 0) {
+    return 0;
+  }
+  int16_t chars = static_cast<int16_t>(Read(Add(string, kStringChars)));
+  auto char_at = [this, chars](int16_t j) {
+    return static_cast<int16_t>(Read(Add(j, chars)));
+  };
+  int16_t j = 0;
+  int16_t value = 0;
+  bool is_digit = true;
+  bool negative = false;
+  if (char_at(0) == '-') {
+    negative = true;
+    j = 1;
+  }
+  while (j < StringLength(string) && is_digit) {
+    int16_t digit = Sub(char_at(j), '0');
+    is_digit = !(digit < 0 || digit > 9);
+    if (is_digit) {
+      value = Add(MathMultiply(value, 10), digit);
+      j = Add(j, 1);
+    }
+  }
+  return negative ? Neg(value) : value;
+}
+
+int16_t BuiltIns::StringSetInt(int16_t string, int16_t number) {
+  int16_t max_length = static_cast<int16_t>(Read(Add(string, kStringMaxLength)));
+  if (max_length == 0) {
+    throw Declined();
+  }
+  // The digits go into a buffer last first, and then into the string.
+  int16_t buffer = ArrayNew(6);
+  int16_t count = 0;
+  bool negative = false;
+  if (number < 0) {
+    negative = true;
+    number = Neg(number);
+  }
+  int16_t quotient = number;
+  while (quotient > 0) {
+    quotient = MathDivide(number, 10);
+    Store(Add(count, buffer), Add('0', Sub(number, MathMultiply(quotient, 10))));
+    count = Add(count, 1);
+    number = quotient;
+  }
+  if (negative) {
+    Store(Add(count, buffer), '-');
+    count = Add(count, 1);
+  }
+  if (max_length < count) {
+    throw Declined();
+  }
+  int16_t chars = static_cast<int16_t>(Read(Add(string, kStringChars)));
+  if (count == 0) {
+    Store(chars, '0');
+    Write(Add(string, kStringLength), 1);
+  } else {
+    Write(Add(string, kStringLength), 0);
+    for (int16_t length = 0; length < count; length = StringLength(string)) {
+      Store(Add(length, chars),
+            static_cast<int16_t>(Read(Add(Sub(count, Add(length, 1)), buffer))));
+      Write(Add(string, kStringLength), Add(length, 1));
+    }
+  }
+  Discard(ArrayDispose(buffer));
+  return 0;
+}
+
+int16_t BuiltIns::ScreenClearScreen() {
+  for (int16_t i = 0; i < 8192; i++) {
+    Store(Add(i, Static(screen_statics_, kScreenBase)), 0);
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ScreenUpdateLocation(int16_t address, int16_t mask) {
+  address = Add(address, Static(screen_statics_, kScreenBase));
+  int16_t word = static_cast<int16_t>(Read(address));
+  if (Static(screen_statics_, kScreenColor) != 0) {
+    Store(address, static_cast<int16_t>(word | mask));
+  } else {
+    Store(address, static_cast<int16_t>(word & Not(mask)));
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ScreenSetColor(int16_t color) {
+  SetStatic(screen_statics_, kScreenColor, color);
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawPixel(int16_t x, int16_t y) {
+  if (x < 0 || x > 511 || y < 0 || y > 255) {
+    throw Declined();
+  }
+  int16_t column = MathDivide(x, 16);
+  int16_t bit = Sub(x, MathMultiply(column, 16));
+  int16_t address = Add(MathMultiply(y, 32), column);
+  Discard(ScreenUpdateLocation(address, static_cast<int16_t>(
+    Read(Add(bit, Static(screen_statics_, kScreenBits))))));
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawConditional(int16_t x, int16_t y, int16_t swapped) {
+  if (swapped != 0) {
+    Discard(ScreenDrawPixel(y, x));
+  } else {
+    Discard(ScreenDrawPixel(x, y));
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+  if (x1 < 0 || x2 > 511 || y1 < 0 || y2 > 255) {
+    throw Declined();
+  }
+  // Bresenham's algorithm, stepping along the longer axis, which becomes
+  // x when |swapped|.
+  int16_t dx = MathAbs(Sub(x2, x1));
+  int16_t dy = MathAbs(Sub(y2, y1));
+  bool swapped = dx < dy;
+  if ((swapped && y2 < y1) || (!swapped && x2 < x1)) {
+    std::swap(x1, x2);
+    std::swap(y1, y2);
+  }
+  int16_t a;
+  int16_t b;
+  int16_t end;
+  bool decreasing;
+  if (swapped) {
+    std::swap(dx, dy);
+    a = y1;
+    b = x1;
+    end = y2;
+    decreasing = x1 > x2;
+  } else {
+    a = x1;
+    b = y1;
+    end = x2;
+    decreasing = y1 > y2;
+  }
+  int16_t error = Sub(MathMultiply(2, dy), dx);
+  int16_t step_straight = MathMultiply(2, dy);
+  int16_t step_diagonal = MathMultiply(2, Sub(dy, dx));
+  Discard(ScreenDrawConditional(a, b, Bool(swapped)));
+  while (a < end) {
+    if (error < 0) {
+      error = Add(error, step_straight);
+    } else {
+      error = Add(error, step_diagonal);
+      b = decreasing ? Sub(b, 1) : Add(b, 1);
+    }
+    a = Add(a, 1);
+    Discard(ScreenDrawConditional(a, b, Bool(swapped)));
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawRectangle(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+  if (x1 > x2 || y1 > y2 || x1 < 0 || x2 > 511 || y1 < 0 || y2 > 255) {
+    throw Declined();
+  }
+  int16_t bits = Static(screen_statics_, kScreenBits);
+  int16_t first_column = MathDivide(x1, 16);
+  int16_t first_bit = Sub(x1, MathMultiply(first_column, 16));
+  int16_t last_column = MathDivide(x2, 16);
+  int16_t last_bit = Sub(x2, MathMultiply(last_column, 16));
+  int16_t first_mask = Not(Sub(static_cast<int16_t>(Read(Add(first_bit, bits))), 1));
+  int16_t last_mask = Sub(static_cast<int16_t>(Read(Add(Add(last_bit, 1), bits))), 1);
+  int16_t address = Add(MathMultiply(y1, 32), first_column);
+  int16_t width = Sub(last_column, first_column);
+  while (!(y1 > y2)) {
+    int16_t last_address = Add(address, width);
+    if (width == 0) {
+      Discard(ScreenUpdateLocation(address, static_cast<int16_t>(last_mask & first_mask)));
+    } else {
+      Discard(ScreenUpdateLocation(address, first_mask));
+      address = Add(address, 1);
+      while (address < last_address) {
+        Discard(ScreenUpdateLocation(address, -1));
+        address = Add(address, 1);
+      }
+      Discard(ScreenUpdateLocation(last_address, last_mask));
+    }
+    y1 = Add(y1, 1);
+    address = Sub(Add(last_address, 32), width);
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawHorizontal(int16_t y, int16_t x1, int16_t x2) {
+  int16_t left = MathMin(x1, x2);
+  int16_t right = MathMax(x1, x2);
+  if (!(y > -1 && y < 256 && left < 512 && right > -1)) {
+    return 0;
+  }
+  int16_t bits = Static(screen_statics_, kScreenBits);
+  left = MathMax(left, 0);
+  right = MathMin(right, 511);
+  int16_t first_column = MathDivide(left, 16);
+  int16_t first_bit = Sub(left, MathMultiply(first_column, 16));
+  int16_t last_column = MathDivide(right, 16);
+  int16_t last_bit = Sub(right, MathMultiply(last_column, 16));
+  int16_t first_mask = Not(Sub(static_cast<int16_t>(Read(Add(first_bit, bits))), 1));
+  int16_t last_mask = Sub(static_cast<int16_t>(Read(Add(Add(last_bit, 1), bits))), 1);
+  int16_t address = Add(MathMultiply(y, 32), first_column);
+  int16_t width = Sub(last_column, first_column);
+  int16_t last_address = Add(address, width);
+  if (width == 0) {
+    Discard(ScreenUpdateLocation(address, static_cast<int16_t>(last_mask & first_mask)));
+  } else {
+    Discard(ScreenUpdateLocation(address, first_mask));
+    address = Add(address, 1);
+    while (address < last_address) {
+      Discard(ScreenUpdateLocation(address, -1));
+      address = Add(address, 1);
+    }
+    Discard(ScreenUpdateLocation(last_address, last_mask));
+  }
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawSymetric(int16_t x, int16_t y, int16_t a, int16_t b) {
+  Discard(ScreenDrawHorizontal(Sub(y, b), Add(x, a), Sub(x, a)));
+  Discard(ScreenDrawHorizontal(Add(y, b), Add(x, a), Sub(x, a)));
+  Discard(ScreenDrawHorizontal(Sub(y, a), Sub(x, b), Add(x, b)));
+  Discard(ScreenDrawHorizontal(Add(y, a), Sub(x, b), Add(x, b)));
+  return 0;
+}
+
+int16_t BuiltIns::ScreenDrawCircle(int16_t x, int16_t y, int16_t r) {
+  if (x < 0 || x > 511 || y < 0 || y > 255) {
+    throw Declined();
+  }
+  if (Sub(x, r) < 0 || Add(x, r) > 511 || Sub(y, r) < 0 || Add(y, r) > 255) {
+    throw Declined();
+  }
+  // The midpoint algorithm, one octant at a time.
+  int16_t a = 0;
+  int16_t b = r;
+  int16_t error = Sub(1, r);
+  Discard(ScreenDrawSymetric(x, y, a, b));
+  while (b > a) {
+    if (error < 0) {
+      error = Add(Add(error, MathMultiply(2, a)), 3);
+    } else {
+      error = Add(Add(error, MathMultiply(2, Sub(a, b))), 5);
+      b = Sub(b, 1);
+    }
+    a = Add(a, 1);
+    Discard(ScreenDrawSymetric(x, y, a, b));
+  }
+  return 0;
+}
+
+int16_t BuiltIns::OutputGetMap(int16_t c) {
+  if (c < 32 || c > 126) {
+    c = 0;
+  }
+  int16_t maps = Static(output_statics_,
+                        Static(output_statics_, kOutputLeftHalf) != 0 ?
+                        kOutputCharMaps : kOutputShiftedMaps);
+  return static_cast<int16_t>(Read(Add(c, maps)));
+}
+
+int16_t BuiltIns::OutputDrawChar(int16_t c) {
+  int16_t map = OutputGetMap(c);
+  int16_t screen = Static(output_statics_, kOutputScreenBase);
+  int16_t address = Static(output_statics_, kOutputCursor);
+  for (int16_t row = 0; row < 11; row++) {
+    int16_t word = static_cast<int16_t>(Read(Add(address, screen)));
+    int16_t kept = Static(output_statics_, kOutputLeftHalf) != 0 ?
+      static_cast<int16_t>(word & -256) : static_cast<int16_t>(word & 255);
+    Store(Add(address, screen),
+          static_cast<int16_t>(static_cast<int16_t>(Read(Add(row, map))) | kept));
+    address = Add(address, 32);
+  }
+  return 0;
+}
+
+int16_t BuiltIns::OutputMoveCursor(int16_t i, int16_t j) {
+  if (i < 0 || i > 22 || j < 0 || j > 63) {
+    throw Declined();
+  }
+  SetStatic(output_statics_, kOutputColumn, MathDivide(j, 2));
+  SetStatic(output_statics_, kOutputCursor,
+            Add(Add(32, MathMultiply(i, 352)), Static(output_statics_, kOutputColumn)));
+  SetStatic(output_statics_, kOutputLeftHalf,
+            Bool(j == MathMultiply(Static(output_statics_, kOutputColumn), 2)));
+  Discard(OutputDrawChar(' '));
+  return 0;
+}
+
+int16_t BuiltIns::OutputPrintChar(int16_t c) {
+  if (c == kNewLine) {
+    Discard(OutputPrintln());
+  } else if (c == kBackSpace) {
+    Discard(OutputBackSpace());
+  } else {
+    Discard(OutputDrawChar(c));
+    if (Static(output_statics_, kOutputLeftHalf) == 0) {
+      SetStatic(output_statics_, kOutputColumn, Add(Static(output_statics_, kOutputColumn), 1));
+      SetStatic(output_statics_, kOutputCursor, Add(Static(output_statics_, kOutputCursor), 1));
+    }
+    if (Static(output_statics_, kOutputColumn) == 32) {
+      Discard(OutputPrintln());
+    } else {
+      SetStatic(output_statics_, kOutputLeftHalf,
+                Not(Static(output_statics_, kOutputLeftHalf)));
+    }
+  }
+  return 0;
+}
+
+int16_t BuiltIns::OutputPrintString(int16_t string) {
+  int16_t length = StringLength(string);
+  for (int16_t i = 0; i < length; i++) {
+    Discard(OutputPrintChar(StringCharAt(string, i)));
+  }
+  return 0;
+}
+
+int16_t BuiltIns::OutputPrintInt(int16_t i) {
+  Discard(StringSetInt(Static(output_statics_, kOutputIntBuffer), i));
+  Discard(OutputPrintString(Static(output_statics_, kOutputIntBuffer)));
+  return 0;
+}
+
+int16_t BuiltIns::OutputPrintln() {
+  SetStatic(output_statics_, kOutputCursor,
+            Sub(Add(Static(output_statics_, kOutputCursor), 352),
+                Static(output_statics_, kOutputColumn)));
+  SetStatic(output_statics_, kOutputColumn, 0);
+  SetStatic(output_statics_, kOutputLeftHalf, kTrue);
+  if (Static(output_statics_, kOutputCursor) == 8128) {
+    SetStatic(output_statics_, kOutputCursor, 32);
+  }
+  return 0;
+}
+
+int16_t BuiltIns::OutputBackSpace() {
+  if (Static(output_statics_, kOutputLeftHalf) != 0) {
+    if (Static(output_statics_, kOutputColumn) > 0) {
+      SetStatic(output_statics_, kOutputColumn, Sub(Static(output_statics_, kOutputColumn), 1));
+      SetStatic(output_statics_, kOutputCursor, Sub(Static(output_statics_, kOutputCursor), 1));
+    } else {
+      SetStatic(output_statics_, kOutputColumn, 31);
+      if (Static(output_statics_, kOutputCursor) == 32) {
+        SetStatic(output_statics_, kOutputCursor, 8128);
+      }
+      SetStatic(output_statics_, kOutputCursor,
+                Sub(Static(output_statics_, kOutputCursor), 321));
+    }
+    SetStatic(output_statics_, kOutputLeftHalf, kFalse);
+  } else {
+    SetStatic(output_statics_, kOutputLeftHalf, kTrue);
+  }
+  Discard(OutputDrawChar(' '));
+  return 0;
+}
+
+int16_t BuiltIns::KeyboardKeyPressed() {
+  return MemoryPeek(static_cast<int16_t>(kKeyboardAddress));
+}
+
+int16_t BuiltIns::SysWait(int16_t duration) {
+  // The VM code only counts down.
+  if (duration < 0) {
+    throw Declined();
+  }
+  return 0;
+}
@@ -0,0 +1,128 @@
+#ifndef VM_EMULATOR_BUILT_INS_HPP
+#define VM_EMULATOR_BUILT_INS_HPP
+
+#include "../vm_translator/vm_instructions/vm-instruction.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Native versions of the Jack OS functions in tools/OS, which the VM
+// emulator runs in place of their VM code, as the Java VM emulator does
+// with its builtInVMCode. Each one is a line-by-line port of the VM code,
+// so it leaves RAM as the VM code would: the same heap blocks, object
+// fields, screen words and OS statics, down to the last value stored in
+// temp 0. Only the stack above SP, where the VM code's frame would have
+// been, is different, as is anything a program reads from there.
+//
+// Where the VM code would call Sys.error, or never return, a built-in
+// gives up and undoes its writes, so that the VM code can run instead. The
+// OS keeps its state in the statics of its classes, so a class's built-ins
+// work on top of its loaded .vm file rather than replacing it, and only
+// when that file is the stock one they were ported from: any other version
+// of the class, such as one compiled from projects/12, runs as VM code.
+class BuiltIns {
+  public:
+    static constexpr size_t kMaxArgCount = 4;
+
+    struct Function {
+      int16_t (*run)(BuiltIns& built_ins, const int16_t* args);
+      size_t arg_count;
+    };
+
+    explicit BuiltIns(uint16_t* ram);
+
+    // The built-in for |function_name|, such as "Math.multiply", or null.
+    static const Function* Find(const std::string& function_name);
+    // The classes whose VM code the built-ins of |class_name| stand in
+    // for, |class_name| included. All of them have to be loaded as the
+    // stock OS code, and none run as VM code, for the built-ins of
+    // |class_name| to be used.
+    static std::vector<std::string> GetDependencies(const std::string& class_name);
+    // True if |instructions| are those of the tools/OS file for
+    // |class_name|, whatever the comments and spacing.
+    static bool IsStockClass(const std::string& class_name,
+                             const VMInstructionSet& instructions);
+
+    // Where the statics of a stock OS class start. Has to be set for each
+    // class a built-in is used with.
+    void SetStaticBase(const std::string& class_name, uint16_t base);
+    // Runs |function| on |args|. Returns false, with RAM as it was, if the
+    // VM code has to run instead.
+    bool Call(const Function& function, const int16_t* args, int16_t* result);
+
+  private:
+    // Thrown to give up on a call.
+    struct Declined {};
+
+    uint16_t Read(int16_t address) const;
+    void Write(int16_t address, int16_t value);
+    int16_t Static(uint16_t base, int index) const;
+    void SetStatic(uint16_t base, int index, int16_t value);
+    // An array element assignment, which the compiler that built the OS
+    // routes through temp 0.
+    void Store(int16_t address, int16_t value);
+    // `pop temp 0` after a call whose value is not used.
+    void Discard(int16_t value);
+
+    int16_t MathAbs(int16_t x);
+    int16_t MathMultiply(int16_t x, int16_t y);
+    int16_t MathDivide(int16_t x, int16_t y);
+    int16_t MathSqrt(int16_t x);
+    int16_t MathMax(int16_t a, int16_t b);
+    int16_t MathMin(int16_t a, int16_t b);
+
+    int16_t MemoryPeek(int16_t address);
+    int16_t MemoryPoke(int16_t address, int16_t value);
+    int16_t MemoryAlloc(int16_t size);
+    int16_t MemoryDeAlloc(int16_t object);
+
+    int16_t ArrayNew(int16_t size);
+    int16_t ArrayDispose(int16_t array);
+
+    int16_t StringNew(int16_t max_length);
+    int16_t StringDispose(int16_t string);
+    int16_t StringLength(int16_t string);
+    int16_t StringCharAt(int16_t string, int16_t j);
+    int16_t StringSetCharAt(int16_t string, int16_t j, int16_t c);
+    int16_t StringAppendChar(int16_t string, int16_t c);
+    int16_t StringEraseLastChar(int16_t string);
+    int16_t StringIntValue(int16_t string);
+    int16_t StringSetInt(int16_t string, int16_t number);
+
+    int16_t ScreenClearScreen();
+    int16_t ScreenUpdateLocation(int16_t address, int16_t mask);
+    int16_t ScreenSetColor(int16_t color);
+    int16_t ScreenDrawPixel(int16_t x, int16_t y);
+    int16_t ScreenDrawConditional(int16_t x, int16_t y, int16_t swapped);
+    int16_t ScreenDrawLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    int16_t ScreenDrawRectangle(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    int16_t ScreenDrawHorizontal(int16_t y, int16_t x1, int16_t x2);
+    int16_t ScreenDrawSymetric(int16_t x, int16_t y, int16_t a, int16_t b);
+    int16_t ScreenDrawCircle(int16_t x, int16_t y, int16_t r);
+
+    int16_t OutputGetMap(int16_t c);
+    int16_t OutputDrawChar(int16_t c);
+    int16_t OutputMoveCursor(int16_t i, int16_t j);
+    int16_t OutputPrintChar(int16_t c);
+    int16_t OutputPrintString(int16_t string);
+    int16_t OutputPrintInt(int16_t i);
+    int16_t OutputPrintln();
+    int16_t OutputBackSpace();
+
+    int16_t KeyboardKeyPressed();
+    int16_t SysWait(int16_t duration);
+
+    uint16_t* ram_;
+    // Writes made by the current call, with the values they replaced.
+    std::vector<std::pair<uint16_t, uint16_t>> journal_;
+    uint16_t math_statics_;
+    uint16_t memory_statics_;
+    uint16_t screen_statics_;
+    uint16_t output_statics_;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "./vm-emulator.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  constexpr char kJackOption[] = "--jack=";
+
+  void PrintUsage() {
+    std::cerr << "Usage: vm-emulator [--jack=Class,...] <file.vm | directory> <steps> "
+              << "[address | address=value]...\n";
+  }
+
+  // The OS classes to run as VM code rather than as built-ins, as in
+  // "--jack=Math,Screen".
+  std::set<std::string> ParseJackClasses(const std::string& option) {
+    std::set<std::string> classes;
+    size_t start = std::string(kJackOption).size();
+    while (start < option.size()) {
+      size_t comma = option.find(',', start);
+      if (comma == std::string::npos) {
+        comma = option.size();
+      }
+      if (comma > start) {
+        classes.insert(option.substr(start, comma - start));
+      }
+      start = comma + 1;
+    }
+    return classes;
+  }
+
+  // Sets the RAM words given as address=value, runs the program for up to
+  // the given number of steps, then prints the RAM words given as address,
+  // and the speed on stderr.
+  int RunProgram(int argc, char** argv, const std::set<std::string>& jack_classes) {
+    VMEmulator emulator;
+    emulator.Load(argv[1], jack_classes);
+    uint64_t steps = std::stoull(argv[2]);
+    for (int i = 3; i < argc; i++) {
+      std::string argument = argv[i];
+      size_t equals = argument.find('=');
+      if (equals != std::string::npos) {
+        emulator.WriteRam(static_cast<uint16_t>(std::stoul(argument.substr(0, equals))),
+                          static_cast<int16_t>(std::stoi(argument.substr(equals + 1))));
+      }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    steps = emulator.Run(steps);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (int i = 3; i < argc; i++) {
+      if (std::string(argv[i]).find('=') != std::string::npos) {
+        continue;
+      }
+      uint16_t address = static_cast<uint16_t>(std::stoul(argv[i]));
+      std::cout << "RAM[" << address << "] = " << emulator.ReadRam(address) << "\n";
+    }
+    std::cerr << steps << " steps in " << elapsed.count() << " s ("
+              << steps / elapsed.count() / 1e6 << " million per second)"
+              << (emulator.IsHalted() ? ", halted" : "") << "\n";
+    return 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::set<std::string> jack_classes;
+  if (argc > 1 && std::string(argv[1]).rfind(kJackOption, 0) == 0) {
+    jack_classes = ParseJackClasses(argv[1]);
+    argc--;
+    argv++;
+  }
+  if (argc < 3) {
+    PrintUsage();
+    return 1;
+  }
+  try {
+    return RunProgram(argc, argv, jack_classes);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+}
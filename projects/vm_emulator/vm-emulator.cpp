@@ -0,0 +1,722 @@
+#include "./vm-emulator.hpp"
+#include "../vm_translator/parser.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  constexpr uint16_t kAddressMask = 0x7fff;
+  constexpr uint16_t kTrue = 0xffff;
+  constexpr uint16_t kFalse = 0;
+
+  constexpr uint16_t kSPAddress = 0;
+  constexpr uint16_t kLCLAddress = 1;
+  constexpr uint16_t kARGAddress = 2;
+  constexpr uint16_t kTHISAddress = 3;
+  constexpr uint16_t kTHATAddress = 4;
+  constexpr uint16_t kTempAddress = 5;
+  constexpr uint16_t kStaticAddress = 16;
+  // LCL, ARG, THIS, THAT and the return address.
+  constexpr uint16_t kFrameSize = 5;
+  // Return addresses are op indices, and have to fit in a RAM word.
+  constexpr size_t kMaxProgramSize = 65536;
+
+  constexpr char kVMExtension[] = ".vm";
+  constexpr char kInitFunction[] = "Sys.init";
+  constexpr char kLabelSeparator[] = "$";
+  constexpr char kClassSeparator = '.';
+
+  using InstructionType = VMInstruction::VMInstructionType;
+  using SegmentType = VMInstruction::MemorySegmentType;
+
+  struct VMFile {
+    std::string module_name;
+    VMInstructionSet instructions;
+  };
+
+  VMFile ReadVMFile(const boost::filesystem::path& path) {
+    std::ifstream in(path.string());
+    if (!in) {
+      throw std::runtime_error("Cannot read " + path.string());
+    }
+    VMFile file = { path.stem().string(), {} };
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(in, line)) {
+      line_number++;
+      boost::optional<VMInstruction> instruction;
+      try {
+        instruction = ParseLine(line);
+      } catch (const std::out_of_range&) {
+        throw std::runtime_error("Bad instruction on line " + std::to_string(line_number) +
+                                 " of " + path.string() + ": " + line);
+      }
+      if (instruction) {
+        file.instructions.push_back(*instruction);
+      }
+    }
+    return file;
+  }
+
+  std::vector<VMFile> ReadVMFiles(const std::string& path_in) {
+    std::vector<boost::filesystem::path> paths;
+    if (boost::filesystem::is_directory(path_in)) {
+      for (const auto& entry : boost::filesystem::directory_iterator(path_in)) {
+        if (entry.path().extension() == kVMExtension) {
+          paths.push_back(entry.path());
+        }
+      }
+      std::sort(paths.begin(), paths.end());
+    } else {
+      paths.push_back(path_in);
+    }
+    std::vector<VMFile> files;
+    for (const auto& path : paths) {
+      files.push_back(ReadVMFile(path));
+    }
+    return files;
+  }
+
+  std::string GetLabelKey(const std::string& function_name, const std::string& label) {
+    return function_name + kLabelSeparator + label;
+  }
+}
+
+VMEmulator::VMEmulator() :
+  ops_(1, { Op::HALT, 0, 0, 0 }), fused_ops_(ops_), ram_(kRamSize, 0),
+  built_ins_(ram_.data()), start_(0), pc_(0), halted_(false) {}
+
+void VMEmulator::Load(const std::string& path, const std::set<std::string>& jack_classes) {
+  std::vector<VMFile> files = ReadVMFiles(path);
+
+  // Labels take up no op, so they name the index of the op after them.
+  // Code before the first function of a file scopes its labels by the
+  // file instead.
+  SymbolTable symbols;
+  std::set<uint32_t> jump_targets;
+  uint32_t index = 0;
+  uint16_t static_base = kStaticAddress;
+  for (const auto& file : files) {
+    symbols.static_bases[file.module_name] = static_base;
+    std::string function_name = file.module_name;
+    for (const auto& instruction : file.instructions) {
+      switch (instruction.GetInstructionType()) {
+        case InstructionType::FUNCTION:
+          function_name = *instruction.GetFunctionName();
+          symbols.functions[function_name] = index;
+          jump_targets.insert(index++);
+          break;
+        case InstructionType::LABEL:
+          symbols.labels[GetLabelKey(function_name, *instruction.GetLabel())] = index;
+          jump_targets.insert(index);
+          break;
+        case InstructionType::PUSH:
+        case InstructionType::POP:
+          if (instruction.GetMemorySegmentType() == SegmentType::STATIC) {
+            static_base = std::max<size_t>(
+              static_base,
+              symbols.static_bases[file.module_name] +
+              *instruction.GetMemorySegmentAddress() + 1);
+          }
+          index++;
+          break;
+        default:
+          index++;
+          break;
+      }
+    }
+  }
+
+  // The built-ins of a class work on the statics of the classes whose VM
+  // code they stand in for, so those all have to be loaded, and laid out
+  // as in the stock OS.
+  std::set<std::string> stock_classes;
+  for (const auto& file : files) {
+    if (BuiltIns::IsStockClass(file.module_name, file.instructions)) {
+      stock_classes.insert(file.module_name);
+      built_ins_.SetStaticBase(file.module_name, symbols.static_bases.at(file.module_name));
+    }
+  }
+  for (const auto& function : symbols.functions) {
+    const BuiltIns::Function* built_in = BuiltIns::Find(function.first);
+    if (built_in == nullptr) {
+      continue;
+    }
+    std::vector<std::string> dependencies =
+      BuiltIns::GetDependencies(function.first.substr(0, function.first.find(kClassSeparator)));
+    bool native = std::all_of(
+      dependencies.begin(), dependencies.end(),
+      [&stock_classes, &jack_classes](const std::string& class_name) {
+        return stock_classes.count(class_name) != 0 && jack_classes.count(class_name) == 0;
+      });
+    if (native) {
+      symbols.built_ins[function.first] = static_cast<uint32_t>(symbols.built_in_calls.size());
+      symbols.built_in_calls.push_back({ built_in, function.second });
+    }
+  }
+
+  ops_.clear();
+  for (const auto& file : files) {
+    std::string function_name = file.module_name;
+    for (const auto& instruction : file.instructions) {
+      if (instruction.GetInstructionType() == InstructionType::LABEL) {
+        continue;
+      }
+      if (instruction.GetInstructionType() == InstructionType::FUNCTION) {
+        function_name = *instruction.GetFunctionName();
+      }
+      ops_.push_back(Resolve(instruction, file.module_name, function_name, symbols));
+    }
+  }
+  ops_.push_back({ Op::HALT, 0, 0, 0 });
+
+  auto init = symbols.functions.find(kInitFunction);
+  if (init == symbols.functions.end()) {
+    start_ = 0;
+  } else {
+    start_ = ops_.size();
+    ops_.push_back({ Op::SET_STACK, 1, kStackAddress, 0 });
+    ops_.push_back({ Op::CALL, 1, 0, init->second });
+    ops_.push_back({ Op::HALT, 0, 0, 0 });
+  }
+  if (ops_.size() > kMaxProgramSize) {
+    throw std::runtime_error("Program too large: " + std::to_string(ops_.size()) +
+                             " instructions");
+  }
+
+  fused_ops_ = ops_;
+  for (size_t i = 0; i + 1 < ops_.size(); i++) {
+    if (jump_targets.count(i + 1) == 0 && Fuse(ops_[i], ops_[i + 1], &fused_ops_[i])) {
+      i++;
+    }
+  }
+  built_in_calls_ = symbols.built_in_calls;
+  pc_ = start_;
+  halted_ = false;
+}
+
+uint64_t VMEmulator::Run(uint64_t steps) {
+  if (halted_) {
+    return 0;
+  }
+  uint64_t steps_left = Execute(fused_ops_, steps);
+  // A superinstruction can stop short of the last step, which the first
+  // half of the pair it stands for then takes.
+  if (steps_left > 0 && !halted_) {
+    steps_left = Execute(ops_, steps_left);
+  }
+  return steps - steps_left;
+}
+
+int16_t VMEmulator::ReadRam(uint16_t address) const {
+  return static_cast<int16_t>(ram_[address & kAddressMask]);
+}
+
+void VMEmulator::WriteRam(uint16_t address, int16_t value) {
+  ram_[address & kAddressMask] = static_cast<uint16_t>(value);
+}
+
+VMEmulator::MicroOp VMEmulator::Resolve(const VMInstruction& instruction,
+                                        const std::string& module_name,
+                                        const std::string& function_name,
+                                        const SymbolTable& symbols) {
+  MicroOp op = { Op::HALT, 1, 0, 0 };
+  switch (instruction.GetInstructionType()) {
+    case InstructionType::ADD: op.op = Op::ADD; break;
+    case InstructionType::SUB: op.op = Op::SUB; break;
+    case InstructionType::NEG: op.op = Op::NEG; break;
+    case InstructionType::EQ: op.op = Op::EQ; break;
+    case InstructionType::GT: op.op = Op::GT; break;
+    case InstructionType::LT: op.op = Op::LT; break;
+    case InstructionType::AND: op.op = Op::AND; break;
+    case InstructionType::OR: op.op = Op::OR; break;
+    case InstructionType::NOT: op.op = Op::NOT; break;
+    case InstructionType::RETURN: op.op = Op::RETURN; break;
+
+    case InstructionType::PUSH:
+    case InstructionType::POP: {
+      bool push = instruction.GetInstructionType() == InstructionType::PUSH;
+      size_t index = *instruction.GetMemorySegmentAddress();
+      op.value = static_cast<uint16_t>(index);
+      switch (*instruction.GetMemorySegmentType()) {
+        case SegmentType::CONSTANT:
+          if (!push) {
+            throw std::runtime_error("Cannot pop to constant in " + function_name);
+          }
+          op.op = Op::PUSH_CONSTANT;
+          break;
+        case SegmentType::LOCAL: op.op = push ? Op::PUSH_LOCAL : Op::POP_LOCAL; break;
+        case SegmentType::ARGUMENT: op.op = push ? Op::PUSH_ARGUMENT : Op::POP_ARGUMENT; break;
+        case SegmentType::THIS: op.op = push ? Op::PUSH_THIS : Op::POP_THIS; break;
+        case SegmentType::THAT: op.op = push ? Op::PUSH_THAT : Op::POP_THAT; break;
+        case SegmentType::POINTER:
+          if (index > 1) {
+            throw std::runtime_error("Bad pointer index " + std::to_string(index) +
+                                     " in " + function_name);
+          }
+          op.op = push ? Op::PUSH_POINTER : Op::POP_POINTER;
+          break;
+        case SegmentType::TEMP:
+          op.op = push ? Op::PUSH_FIXED : Op::POP_FIXED;
+          op.value = static_cast<uint16_t>(kTempAddress + index) & kAddressMask;
+          break;
+        case SegmentType::STATIC:
+          op.op = push ? Op::PUSH_FIXED : Op::POP_FIXED;
+          op.value = static_cast<uint16_t>(symbols.static_bases.at(module_name) + index) &
+                     kAddressMask;
+          break;
+        default:
+          throw std::runtime_error("Bad memory segment in " + function_name);
+      }
+      break;
+    }
+
+    case InstructionType::GOTO:
+    case InstructionType::IFGOTO: {
+      op.op = instruction.GetInstructionType() == InstructionType::GOTO ?
+        Op::GOTO : Op::IF_GOTO;
+      auto label = symbols.labels.find(GetLabelKey(function_name, *instruction.GetLabel()));
+      if (label == symbols.labels.end()) {
+        throw std::runtime_error("Undefined label " + *instruction.GetLabel() +
+                                 " in " + function_name);
+      }
+      op.target = label->second;
+      break;
+    }
+
+    case InstructionType::CALL: {
+      op.op = Op::CALL;
+      op.value = static_cast<uint16_t>(*instruction.GetNArgs());
+      auto function = symbols.functions.find(*instruction.GetFunctionName());
+      if (function == symbols.functions.end()) {
+        throw std::runtime_error("Call to undefined function " +
+                                 *instruction.GetFunctionName() + " in " + function_name);
+      }
+      op.target = function->second;
+      auto built_in = symbols.built_ins.find(*instruction.GetFunctionName());
+      if (built_in != symbols.built_ins.end() &&
+          symbols.built_in_calls[built_in->second].function->arg_count == op.value) {
+        op.op = Op::CALL_BUILT_IN;
+        op.target = built_in->second;
+      }
+      break;
+    }
+
+    case InstructionType::FUNCTION:
+      op.op = Op::FUNCTION;
+      op.value = static_cast<uint16_t>(*instruction.GetNVars());
+      break;
+
+    default:
+      throw std::runtime_error("Bad instruction in " + function_name);
+  }
+  return op;
+}
+
+bool VMEmulator::Fuse(const MicroOp& first, const MicroOp& second, MicroOp* fused) {
+  *fused = first;
+  fused->steps = first.steps + second.steps;
+  switch (first.op) {
+    case Op::PUSH_CONSTANT:
+      switch (second.op) {
+        case Op::ADD: fused->op = Op::PUSH_CONSTANT_ADD; return true;
+        case Op::SUB: fused->op = Op::PUSH_CONSTANT_SUB; return true;
+        case Op::EQ: fused->op = Op::PUSH_CONSTANT_EQ; return true;
+        case Op::GT: fused->op = Op::PUSH_CONSTANT_GT; return true;
+        case Op::LT: fused->op = Op::PUSH_CONSTANT_LT; return true;
+        default: break;
+      }
+      break;
+    case Op::EQ:
+    case Op::GT:
+    case Op::LT:
+    case Op::NOT:
+      if (second.op == Op::IF_GOTO) {
+        fused->op = first.op == Op::EQ ? Op::EQ_IF_GOTO :
+                    first.op == Op::GT ? Op::GT_IF_GOTO :
+                    first.op == Op::LT ? Op::LT_IF_GOTO : Op::NOT_IF_GOTO;
+        fused->target = second.target;
+        return true;
+      }
+      break;
+    case Op::POP_POINTER:
+      // Reading an array element: pop pointer 1, push that i.
+      if (first.value == 1 && second.op == Op::PUSH_THAT) {
+        fused->op = Op::POP_POINTER_PUSH_THAT;
+        fused->value = second.value;
+        return true;
+      }
+      break;
+    default:
+      break;
+  }
+  *fused = first;
+  return false;
+}
+
+uint64_t VMEmulator::Execute(const std::vector<MicroOp>& ops, uint64_t steps) {
+  // The handlers, in the order of Op. Jumping to them through a table of
+  // label addresses is a GCC and Clang extension.
+  static const void* const kHandlers[] = {
+    &&push_constant,
+    &&push_local, &&push_argument, &&push_this, &&push_that, &&push_pointer,
+    &&push_fixed,
+    &&pop_local, &&pop_argument, &&pop_this, &&pop_that, &&pop_pointer, &&pop_fixed,
+    &&add, &&sub, &&neg, &&eq, &&gt, &&lt, &&bit_and, &&bit_or, &&bit_not,
+    &&go_to, &&if_go_to,
+    &&call, &&function, &&return_,
+    &&call_built_in,
+    &&set_stack, &&halt,
+    &&push_constant_add, &&push_constant_sub,
+    &&push_constant_eq, &&push_constant_gt, &&push_constant_lt,
+    &&eq_if_go_to, &&gt_if_go_to, &&lt_if_go_to, &&not_if_go_to,
+    &&pop_pointer_push_that
+  };
+
+  // The registers live in locals so that the compiler can keep them in
+  // machine registers. The stack never reaches below 256, but a segment
+  // access may go anywhere, so those go through read and write.
+  uint16_t* ram = ram_.data();
+  const MicroOp* program = ops.data();
+  uint16_t sp = ram[kSPAddress];
+  uint16_t lcl = ram[kLCLAddress];
+  uint16_t arg = ram[kARGAddress];
+  uint16_t ths = ram[kTHISAddress];
+  uint16_t tht = ram[kTHATAddress];
+  uint32_t pc = pc_;
+  const MicroOp* op;
+
+  auto save_registers = [&]() {
+    pc_ = pc;
+    ram[kSPAddress] = sp;
+    ram[kLCLAddress] = lcl;
+    ram[kARGAddress] = arg;
+    ram[kTHISAddress] = ths;
+    ram[kTHATAddress] = tht;
+  };
+  auto load_registers = [&]() {
+    sp = ram[kSPAddress];
+    lcl = ram[kLCLAddress];
+    arg = ram[kARGAddress];
+    ths = ram[kTHISAddress];
+    tht = ram[kTHATAddress];
+  };
+  auto read = [&](uint16_t address) -> uint16_t {
+    address &= kAddressMask;
+    switch (address) {
+      case kSPAddress: return sp;
+      case kLCLAddress: return lcl;
+      case kARGAddress: return arg;
+      case kTHISAddress: return ths;
+      case kTHATAddress: return tht;
+      default: return ram[address];
+    }
+  };
+  auto write = [&](uint16_t address, uint16_t value) {
+    address &= kAddressMask;
+    switch (address) {
+      case kSPAddress: sp = value; break;
+      case kLCLAddress: lcl = value; break;
+      case kARGAddress: arg = value; break;
+      case kTHISAddress: ths = value; break;
+      case kTHATAddress: tht = value; break;
+      default: ram[address] = value; break;
+    }
+  };
+  auto push = [&](uint16_t value) {
+    ram[sp & kAddressMask] = value;
+    sp++;
+  };
+  auto pop = [&]() -> uint16_t {
+    sp--;
+    return ram[sp & kAddressMask];
+  };
+  // Stores what the first half of a superinstruction leaves just above the
+  // stack, so that RAM ends up the same as without superinstructions.
+  auto push_hidden = [&](uint16_t value) {
+    ram[sp & kAddressMask] = value;
+  };
+  auto top = [&]() -> uint16_t& {
+    return ram[(sp - 1) & kAddressMask];
+  };
+  // The same frame as the translator's, with an op index for the return
+  // address.
+  auto call_function = [&](uint16_t arg_count, uint32_t target) {
+    push(static_cast<uint16_t>(pc + 1));
+    push(lcl);
+    push(arg);
+    push(ths);
+    push(tht);
+    arg = sp - kFrameSize - arg_count;
+    lcl = sp;
+    pc = target;
+  };
+  auto compare = [](bool condition) -> uint16_t {
+    return condition ? kTrue : kFalse;
+  };
+  auto less = [](uint16_t x, uint16_t y) {
+    return static_cast<int16_t>(x) < static_cast<int16_t>(y);
+  };
+
+  // Every handler ends in its own copy of the dispatch, so that each has
+  // its own indirect jump for the branch predictor to learn.
+#define DISPATCH()                                              \
+  do {                                                          \
+    op = &program[pc];                                          \
+    if (op->steps > steps) {                                    \
+      goto stop;                                                \
+    }                                                           \
+    steps -= op->steps;                                         \
+    goto *kHandlers[static_cast<size_t>(op->op)];               \
+  } while (false)
+
+  DISPATCH();
+
+push_constant:
+  push(op->value);
+  pc++;
+  DISPATCH();
+push_local:
+  push(read(lcl + op->value));
+  pc++;
+  DISPATCH();
+push_argument:
+  push(read(arg + op->value));
+  pc++;
+  DISPATCH();
+push_this:
+  push(read(ths + op->value));
+  pc++;
+  DISPATCH();
+push_that:
+  push(read(tht + op->value));
+  pc++;
+  DISPATCH();
+push_pointer:
+  push(op->value == 0 ? ths : tht);
+  pc++;
+  DISPATCH();
+push_fixed:
+  push(ram[op->value]);
+  pc++;
+  DISPATCH();
+pop_local: {
+  uint16_t value = pop();
+  write(lcl + op->value, value);
+  pc++;
+  DISPATCH();
+}
+pop_argument: {
+  uint16_t value = pop();
+  write(arg + op->value, value);
+  pc++;
+  DISPATCH();
+}
+pop_this: {
+  uint16_t value = pop();
+  write(ths + op->value, value);
+  pc++;
+  DISPATCH();
+}
+pop_that: {
+  uint16_t value = pop();
+  write(tht + op->value, value);
+  pc++;
+  DISPATCH();
+}
+pop_pointer:
+  (op->value == 0 ? ths : tht) = pop();
+  pc++;
+  DISPATCH();
+pop_fixed:
+  ram[op->value] = pop();
+  pc++;
+  DISPATCH();
+
+add: {
+  uint16_t y = pop();
+  top() += y;
+  pc++;
+  DISPATCH();
+}
+sub: {
+  uint16_t y = pop();
+  top() -= y;
+  pc++;
+  DISPATCH();
+}
+neg:
+  top() = -top();
+  pc++;
+  DISPATCH();
+eq: {
+  uint16_t y = pop();
+  top() = compare(top() == y);
+  pc++;
+  DISPATCH();
+}
+gt: {
+  uint16_t y = pop();
+  top() = compare(less(y, top()));
+  pc++;
+  DISPATCH();
+}
+lt: {
+  uint16_t y = pop();
+  top() = compare(less(top(), y));
+  pc++;
+  DISPATCH();
+}
+bit_and: {
+  uint16_t y = pop();
+  top() &= y;
+  pc++;
+  DISPATCH();
+}
+bit_or: {
+  uint16_t y = pop();
+  top() |= y;
+  pc++;
+  DISPATCH();
+}
+bit_not:
+  top() = ~top();
+  pc++;
+  DISPATCH();
+
+go_to:
+  pc = op->target;
+  DISPATCH();
+if_go_to:
+  pc = pop() != 0 ? op->target : pc + 1;
+  DISPATCH();
+
+call:
+  call_function(op->value, op->target);
+  DISPATCH();
+function:
+  for (uint16_t i = 0; i < op->value; i++) {
+    push(0);
+  }
+  pc++;
+  DISPATCH();
+return_: {
+  uint16_t frame = lcl;
+  uint16_t return_address = read(frame - kFrameSize);
+  write(arg, pop());
+  sp = arg + 1;
+  tht = read(frame - 1);
+  ths = read(frame - 2);
+  arg = read(frame - 3);
+  lcl = read(frame - 4);
+  if (return_address >= ops.size()) {
+    halted_ = true;
+    save_registers();
+    throw std::runtime_error("Return to an address outside the program: " +
+                             std::to_string(return_address));
+  }
+  pc = return_address;
+  DISPATCH();
+}
+
+call_built_in: {
+  const BuiltInCall& call = built_in_calls_[op->target];
+  int16_t args[BuiltIns::kMaxArgCount];
+  for (uint16_t i = 0; i < op->value; i++) {
+    args[i] = static_cast<int16_t>(ram[(sp - op->value + i) & kAddressMask]);
+  }
+  // The built-in sees RAM as the VM code would, and may write anywhere.
+  save_registers();
+  int16_t result;
+  bool done = built_ins_.Call(*call.function, args, &result);
+  load_registers();
+  if (done) {
+    sp -= op->value;
+    push(static_cast<uint16_t>(result));
+    pc++;
+  } else {
+    call_function(op->value, call.function_index);
+  }
+  DISPATCH();
+}
+
+set_stack:
+  sp = op->value;
+  pc++;
+  DISPATCH();
+halt:
+  halted_ = true;
+  goto stop;
+
+push_constant_add:
+  push_hidden(op->value);
+  top() += op->value;
+  pc += 2;
+  DISPATCH();
+push_constant_sub:
+  push_hidden(op->value);
+  top() -= op->value;
+  pc += 2;
+  DISPATCH();
+push_constant_eq:
+  push_hidden(op->value);
+  top() = compare(top() == op->value);
+  pc += 2;
+  DISPATCH();
+push_constant_gt:
+  push_hidden(op->value);
+  top() = compare(less(op->value, top()));
+  pc += 2;
+  DISPATCH();
+push_constant_lt:
+  push_hidden(op->value);
+  top() = compare(less(top(), op->value));
+  pc += 2;
+  DISPATCH();
+eq_if_go_to: {
+  uint16_t y = pop();
+  uint16_t x = pop();
+  bool jump = x == y;
+  push_hidden(compare(jump));
+  pc = jump ? op->target : pc + 2;
+  DISPATCH();
+}
+gt_if_go_to: {
+  uint16_t y = pop();
+  uint16_t x = pop();
+  bool jump = less(y, x);
+  push_hidden(compare(jump));
+  pc = jump ? op->target : pc + 2;
+  DISPATCH();
+}
+lt_if_go_to: {
+  uint16_t y = pop();
+  uint16_t x = pop();
+  bool jump = less(x, y);
+  push_hidden(compare(jump));
+  pc = jump ? op->target : pc + 2;
+  DISPATCH();
+}
+not_if_go_to: {
+  uint16_t x = pop();
+  push_hidden(~x);
+  pc = x != kTrue ? op->target : pc + 2;
+  DISPATCH();
+}
+pop_pointer_push_that:
+  tht = pop();
+  push(read(tht + op->value));
+  pc += 2;
+  DISPATCH();
+
+#undef DISPATCH
+
+stop:
+  save_registers();
+  return steps;
+}
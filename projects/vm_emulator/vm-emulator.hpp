@@ -0,0 +1,139 @@
+#ifndef VM_EMULATOR_VM_EMULATOR_HPP
+#define VM_EMULATOR_VM_EMULATOR_HPP
+
+#include "./built-ins.hpp"
+#include "../vm_translator/vm_instructions/vm-instruction.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Runs VM programs directly, against a host array laid out like Hack RAM:
+// SP, LCL, ARG, THIS and THAT in RAM[0-4], temp at 5-12, statics from 16
+// and the stack from 256. A program goes through the same ParseLine as in
+// the VM translator, and then each instruction is resolved once into a
+// MicroOp: segments become base registers or fixed addresses, and labels
+// and function names become indices into the program.
+//
+// The run loop is threaded: every handler jumps straight to the next one
+// through a table of label addresses, rather than going back to a switch.
+// Common pairs of instructions, such as `push constant k; add`, also run
+// as one superinstruction. A pair is never fused across a label, so every
+// jump lands on the first instruction of one.
+//
+// Calls to the Jack OS functions in BuiltIns run natively when the stock
+// tools/OS .vm files are part of the program, and fall back to the VM code
+// where the built-in declines. Usage:
+//
+//   VMEmulator emulator;
+//   emulator.Load("projects/08/FunctionCalls/FibonacciElement");
+//   emulator.Run(100000);
+//   int16_t result = emulator.ReadRam(261);
+class VMEmulator {
+  public:
+    static constexpr size_t kRamSize = 32768;
+    static constexpr uint16_t kStackAddress = 256;
+
+    VMEmulator();
+    // The built-ins keep a pointer into RAM.
+    VMEmulator(const VMEmulator&) = delete;
+    VMEmulator& operator=(const VMEmulator&) = delete;
+
+    // Loads a .vm file, or all the .vm files in a directory, in name
+    // order, and resets the emulator to the start of the program. If the
+    // program has a Sys.init, the start is a bootstrap that sets SP to 256
+    // and calls Sys.init, as the translator's is. Otherwise it is the first
+    // instruction of the first file. Leaves RAM as it is. Throws
+    // std::runtime_error on files it cannot read or parse, and on labels
+    // or functions that are used but never defined. The OS classes in
+    // |jack_classes|, and those whose built-ins depend on them, run as VM
+    // code.
+    void Load(const std::string& path, const std::set<std::string>& jack_classes = {});
+    // Runs up to |steps| VM instructions, stopping early if the program
+    // halts, and returns how many ran. Labels do not count.
+    uint64_t Run(uint64_t steps);
+    // True once the program has run past its last instruction, or Sys.init
+    // has returned.
+    bool IsHalted() const { return halted_; }
+
+    // Addresses wrap at the 15 bits the Hack CPU has.
+    int16_t ReadRam(uint16_t address) const;
+    void WriteRam(uint16_t address, int16_t value);
+
+  private:
+    enum class Op : uint8_t {
+      PUSH_CONSTANT,
+      PUSH_LOCAL, PUSH_ARGUMENT, PUSH_THIS, PUSH_THAT, PUSH_POINTER,
+      // Static and temp, whose addresses are known when loading.
+      PUSH_FIXED,
+      POP_LOCAL, POP_ARGUMENT, POP_THIS, POP_THAT, POP_POINTER, POP_FIXED,
+      ADD, SUB, NEG, EQ, GT, LT, AND, OR, NOT,
+      GOTO, IF_GOTO,
+      CALL, FUNCTION, RETURN,
+      // A call to a function with a built-in.
+      CALL_BUILT_IN,
+      // The start of the bootstrap, and the end of the program.
+      SET_STACK, HALT,
+      // Superinstructions for pairs of the above.
+      PUSH_CONSTANT_ADD, PUSH_CONSTANT_SUB,
+      PUSH_CONSTANT_EQ, PUSH_CONSTANT_GT, PUSH_CONSTANT_LT,
+      EQ_IF_GOTO, GT_IF_GOTO, LT_IF_GOTO, NOT_IF_GOTO,
+      POP_POINTER_PUSH_THAT
+    };
+
+    struct MicroOp {
+      Op op;
+      // The number of VM instructions the op stands for.
+      uint8_t steps;
+      // The constant, segment index or address of a push or pop, the local
+      // count of a function, or the argument count of a call. For
+      // POP_POINTER_PUSH_THAT, the index into that of its push.
+      uint16_t value;
+      // The index of the op to jump to, of the function to call, or of the
+      // BuiltInCall of a CALL_BUILT_IN.
+      uint32_t target;
+    };
+
+    struct BuiltInCall {
+      const BuiltIns::Function* function;
+      // Where the VM code of the function starts.
+      uint32_t function_index;
+    };
+
+    // Where labels, functions and each file's statics are.
+    struct SymbolTable {
+      std::map<std::string, uint32_t> functions;
+      // By function, then label, as in "Main.main$WHILE_EXP0".
+      std::map<std::string, uint32_t> labels;
+      std::map<std::string, uint16_t> static_bases;
+      // By function, the index into |built_in_calls| of its built-in.
+      std::map<std::string, uint32_t> built_ins;
+      std::vector<BuiltInCall> built_in_calls;
+    };
+
+    static MicroOp Resolve(const VMInstruction& instruction,
+                           const std::string& module_name,
+                           const std::string& function_name,
+                           const SymbolTable& symbols);
+    static bool Fuse(const MicroOp& first, const MicroOp& second, MicroOp* fused);
+    // Runs |ops| until the next op would go over |steps| or the program
+    // halts, and returns the steps left.
+    uint64_t Execute(const std::vector<MicroOp>& ops, uint64_t steps);
+
+    // One op per VM instruction. Where two of them fuse, the first op of
+    // the pair in |fused_ops_| is the superinstruction, and the second is
+    // left as it is, which is what makes it possible to stop between them.
+    std::vector<MicroOp> ops_;
+    std::vector<MicroOp> fused_ops_;
+    std::vector<BuiltInCall> built_in_calls_;
+    std::vector<uint16_t> ram_;
+    BuiltIns built_ins_;
+    uint32_t start_;
+    uint32_t pc_;
+    bool halted_;
+};
+
+#endif
@@ -20,8 +20,11 @@ namespace {
   const std::string kIncrementARegisterComp = "A+1";
   const std::string kIncrementDRegisterComp = "D+1";
   const std::string kAPlusDComputation = "A+D";
+  const std::string kDPlusMComp = "D+M";
+  const std::string kAMRegisters = "AM";
   const std::string kDMinusAComp = "D-A";
   const std::string kMMinusAComp = "M-A";
+  const std::string kMMinusDComp = "M-D";
   const std::string kFalseComp = "0";
   const std::string kTrueComp = "-1";
   const std::string kUnconditionalJumpComp = "0";
@@ -29,6 +32,11 @@ namespace {
   const std::string kNEJump = "JNE";
   const std::string kSystemInitMethod = "Sys.init";
   const size_t kStackPointerInit = 256;
+  // Saved return address, LCL, ARG, THIS and THAT.
+  const size_t kCallFrameSize = 5;
+  // Scratch registers used while a tail call moves its frame into place.
+  const std::string kTailCallSourceRegister = "13";
+  const std::string kTailCallDestRegister = "14";
 
   const std::map<VMInstruction::VMInstructionType, std::string> kOperationTypesToComputations {
     { VMInstruction::VMInstructionType::ADD, "M+D" },
@@ -69,16 +77,98 @@ namespace {
     { VMInstruction::MemorySegmentType::LOCAL, "1" },
     { VMInstruction::MemorySegmentType::ARGUMENT, "2" },
     { VMInstruction::MemorySegmentType::THIS, "3" },
-    { VMInstruction::MemorySegmentType::THAT, "4" },
-    { VMInstruction::MemorySegmentType::TEMP, "5" },
-    { VMInstruction::MemorySegmentType::POINTER, "3" }
+    { VMInstruction::MemorySegmentType::THAT, "4" }
   };
 
-  const std::set<VMInstruction::MemorySegmentType> kIndirectMemorySegmentAddrs {
-    VMInstruction::MemorySegmentType::POINTER,
-    VMInstruction::MemorySegmentType::TEMP
+  // Segments mapped onto a fixed RAM range; segment[i] lives at base + i.
+  const std::map<VMInstruction::MemorySegmentType, size_t> kFixedMemorySegmentBaseAddrs {
+    { VMInstruction::MemorySegmentType::POINTER, 3 },
+    { VMInstruction::MemorySegmentType::TEMP, 5 },
+    { VMInstruction::MemorySegmentType::REGISTER, 13 }
   };
 
+  // Scratch slots in the TEMP segment used by `return`.
+  const size_t kEndFrameTempOffset = 3;
+  const size_t kReturnAddressTempOffset = 4;
+
+  // Cost model for reaching segment[offset] through a base pointer. The
+  // "chain" form walks the pointer with A=M+1 / A=A+1 and leaves D untouched;
+  // the "via D" form is @offset / D=A / @SEG / A=D+M.
+  const size_t kOffsetViaDRegisterCost = 4;
+
+  // `pop` to a large offset cannot use D for the address, so it temporarily
+  // adds the offset to the base pointer, stores, and subtracts it again.
+  const size_t kPopWithBaseAdjustCost = 13;
+
+  // @SP / AM=M-1 / D=M, plus the final M=D.
+  const size_t kPopValueToDRegisterCost = 3;
+  const size_t kStoreDRegisterCost = 1;
+
+  size_t GetOffsetChainCost(size_t offset) {
+    return offset == 0 ? 2 : offset + 1;
+  }
+
+  bool IsFixedMemorySegment(VMInstruction::MemorySegmentType segment_type) {
+    return kFixedMemorySegmentBaseAddrs.find(segment_type)
+      != kFixedMemorySegmentBaseAddrs.end();
+  }
+
+  std::string GetFixedMemorySegmentAddress(
+    VMInstruction::MemorySegmentType segment_type, size_t offset) {
+    return std::to_string(kFixedMemorySegmentBaseAddrs.at(segment_type) + offset);
+  }
+
+  // Points A at segment[offset] for a segment addressed through a base
+  // pointer (LCL, ARG, THIS, THAT) without touching the D register.
+  AssemblyInstructionSet
+  GetOffsetChainToARegisterInstructionSet(
+    VMInstruction::MemorySegmentType segment_type, size_t offset) {
+    AssemblyInstructionSet assembly;
+    assembly.push_back(
+      std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(segment_type)));
+    if (offset == 0) {
+      assembly.push_back(
+        std::make_shared<CInstruction>(/*comp=*/kMRegister, /*dest=*/kARegister));
+      return assembly;
+    }
+    assembly.push_back(
+      std::make_shared<CInstruction>(/*comp=*/kIncrementMRegisterComp, /*dest=*/kARegister));
+    for (size_t i = 1; i < offset; i++) {
+      assembly.push_back(
+        std::make_shared<CInstruction>(/*comp=*/kIncrementARegisterComp, /*dest=*/kARegister));
+    }
+    return assembly;
+  }
+
+  // Adds (or subtracts) |offset| to the base pointer of |segment_type| in
+  // place. Clobbers D.
+  AssemblyInstructionSet
+  GetAdjustSegmentBaseInstructionSet(
+    VMInstruction::MemorySegmentType segment_type, size_t offset, bool add) {
+    AssemblyInstructionSet assembly;
+    assembly.push_back(std::make_shared<AInstruction>(std::to_string(offset)));
+    assembly.push_back(
+      std::make_shared<CInstruction>(/*comp=*/kARegister, /*dest=*/kDRegister));
+    assembly.push_back(
+      std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(segment_type)));
+    assembly.push_back(
+      std::make_shared<CInstruction>(
+        /*comp=*/add ? kDPlusMComp : kMMinusDComp, /*dest=*/kMRegister));
+    return assembly;
+  }
+
+  // Pops the top of the stack into D.
+  AssemblyInstructionSet
+  GetPopStackToDRegisterInstructionSet() {
+    AssemblyInstructionSet assembly;
+    assembly.push_back(std::make_shared<AInstruction>(kStackPointerRAMLocation));
+    assembly.push_back(
+      std::make_shared<CInstruction>(/*comp=*/kDecrementMRegisterComp, /*dest=*/kAMRegisters));
+    assembly.push_back(
+      std::make_shared<CInstruction>(/*comp=*/kMRegister, /*dest=*/kDRegister));
+    return assembly;
+  }
+
   AssemblyInstructionSet
   GetLoadStackPointerToARegisterInstructionSet() {
     AssemblyInstructionSet instructions;
@@ -154,10 +244,36 @@ void AssemblyGenerator::GenerateInitAssembly() {
   PushBackAll(GenerateCallInstructionSet(kSystemInitMethod, /*n_args=*/0), &instructions_);
 }
 
+void AssemblyGenerator::FlushPendingInstructions() {
+  if (!pending_call_) {
+    return;
+  }
+  VMInstruction call = *pending_call_;
+  pending_call_ = boost::none;
+  PushBackAll(
+    GenerateCallInstructionSet(*call.GetFunctionName(), *call.GetNArgs()),
+    &instructions_);
+}
+
 void
 AssemblyGenerator::GenerateAssemblyFor(const VMInstruction& instruction) {
   AssemblyInstructionSet assembly;
   VMInstruction::VMInstructionType instruction_type = instruction.GetInstructionType();
+
+  // A `call` directly followed by `return` is a tail call.
+  if (pending_call_ && instruction_type == VMInstruction::VMInstructionType::RETURN) {
+    VMInstruction call = *pending_call_;
+    pending_call_ = boost::none;
+    return PushBackAll(
+      GenerateTailCallInstructionSet(*call.GetFunctionName(), *call.GetNArgs()),
+      &instructions_);
+  }
+  FlushPendingInstructions();
+  if (optimize_tail_calls_ && instruction_type == VMInstruction::VMInstructionType::CALL) {
+    pending_call_ = instruction;
+    return;
+  }
+
   switch (instruction_type) {
     case VMInstruction::VMInstructionType::ADD:
     case VMInstruction::VMInstructionType::SUB:
@@ -181,13 +297,13 @@ AssemblyGenerator::GenerateAssemblyFor(const VMInstruction& instruction) {
         *instruction.GetMemorySegmentAddress());
       break;
     case VMInstruction::VMInstructionType::LABEL:
-      assembly = GenerateLabelInstructionSet(*instruction.GetLabel());
+      assembly = GenerateLabelInstructionSet(MakeScopedLabel(*instruction.GetLabel()));
       break;
     case VMInstruction::VMInstructionType::GOTO:
-      assembly = GenerateGotoInstructionSet(*instruction.GetLabel());
+      assembly = GenerateGotoInstructionSet(MakeScopedLabel(*instruction.GetLabel()));
       break;
     case VMInstruction::VMInstructionType::IFGOTO:
-      assembly = GenerateIfGotoInstructionSet(*instruction.GetLabel());
+      assembly = GenerateIfGotoInstructionSet(MakeScopedLabel(*instruction.GetLabel()));
       break;
     case VMInstruction::VMInstructionType::CALL:
       assembly = GenerateCallInstructionSet(
@@ -195,6 +311,7 @@ AssemblyGenerator::GenerateAssemblyFor(const VMInstruction& instruction) {
         *instruction.GetNArgs());
       break;
     case VMInstruction::VMInstructionType::FUNCTION:
+      current_function_name_ = *instruction.GetFunctionName();
       assembly = GenerateFunctionInstructionSet(
         *instruction.GetFunctionName(),
         *instruction.GetNVars());
@@ -213,6 +330,16 @@ AssemblyGenerator::MakeStaticSymbol(size_t seed) const {
   return symbol.str();
 }
 
+std::string
+AssemblyGenerator::MakeScopedLabel(const std::string& label) const {
+  if (current_function_name_.empty()) {
+    return label;
+  }
+  std::stringstream symbol;
+  symbol << current_function_name_ << "$" << label;
+  return symbol.str();
+}
+
 AssemblyInstructionSet
 AssemblyGenerator::GenerateLabelInstructionSet(const std::string& label) const {
   AssemblyInstructionSet assembly;
@@ -270,35 +397,38 @@ AssemblyGenerator::GetLoadMemorySegmentAddressToARegisterInstructionSet(
     assembly.push_back(
      std::make_shared<AInstruction>(MakeStaticSymbol(memory_segment_address))
     );
-  } else {
-    assembly.push_back(
-      std::make_shared<AInstruction>(
-        kMemorySegmentTypesToRAMAddrs.at(memory_segment_type)));
-
-    if (kIndirectMemorySegmentAddrs.find(memory_segment_type) != kIndirectMemorySegmentAddrs.end()) {
-      assembly.push_back(
-       std::make_shared<CInstruction>(
-         /*comp=*/kARegister,
-         /*dest=*/kDRegister)
-       );
-    } else {
-      assembly.push_back(
-       std::make_shared<CInstruction>(
-         /*comp=*/kMRegister,
-         /*dest=*/kDRegister)
-       );
-    }
+    return assembly;
+  }
 
+  if (IsFixedMemorySegment(memory_segment_type)) {
     assembly.push_back(
-      std::make_shared<AInstruction>(std::to_string(memory_segment_address))
-    );
+      std::make_shared<AInstruction>(
+        GetFixedMemorySegmentAddress(memory_segment_type, memory_segment_address)));
+    return assembly;
+  }
 
-    assembly.push_back(
-     std::make_shared<CInstruction>(
-      /*comp=*/kAPlusDComputation,
-      /*dest=*/kARegister)
-    );
+  // Small offsets are cheaper to reach by walking the base pointer.
+  if (GetOffsetChainCost(memory_segment_address) <= kOffsetViaDRegisterCost) {
+    return GetOffsetChainToARegisterInstructionSet(
+      memory_segment_type, memory_segment_address);
   }
+
+  assembly.push_back(
+    std::make_shared<AInstruction>(std::to_string(memory_segment_address))
+  );
+  assembly.push_back(
+   std::make_shared<CInstruction>(
+     /*comp=*/kARegister,
+     /*dest=*/kDRegister)
+  );
+  assembly.push_back(
+    std::make_shared<AInstruction>(
+      kMemorySegmentTypesToRAMAddrs.at(memory_segment_type)));
+  assembly.push_back(
+   std::make_shared<CInstruction>(
+    /*comp=*/kDPlusMComp,
+    /*dest=*/kARegister)
+  );
   return assembly;
 }
 
@@ -339,43 +469,52 @@ AssemblyGenerator::GeneratePopMemAccessInstructionSet(
   size_t memory_segment_address) const
 {
   AssemblyInstructionSet assembly;
+
+  // Statically known addresses (and small pointer offsets) can be reached
+  // after the popped value is already in D.
+  bool is_statically_addressed =
+    memory_segment_type == VMInstruction::MemorySegmentType::STATIC ||
+    IsFixedMemorySegment(memory_segment_type);
+  size_t chain_cost = kPopValueToDRegisterCost
+                    + GetOffsetChainCost(memory_segment_address)
+                    + kStoreDRegisterCost;
+  if (is_statically_addressed || chain_cost <= kPopWithBaseAdjustCost) {
+    PushBackAll(GetPopStackToDRegisterInstructionSet(), &assembly);
+    if (is_statically_addressed) {
+      PushBackAll(
+        GetLoadMemorySegmentAddressToARegisterInstructionSet(
+          memory_segment_type,
+          memory_segment_address), &assembly);
+    } else {
+      PushBackAll(
+        GetOffsetChainToARegisterInstructionSet(
+          memory_segment_type,
+          memory_segment_address), &assembly);
+    }
+    assembly.push_back(
+     std::make_shared<CInstruction>(
+      /*comp=*/kDRegister,
+      /*dest=*/kMRegister)
+    );
+    return assembly;
+  }
+
+  // Large offset: temporarily move the base pointer onto the target slot.
   PushBackAll(
-    GetLoadMemorySegmentAddressToARegisterInstructionSet(
-      memory_segment_type,
-      memory_segment_address), &assembly);
-  assembly.push_back(
-   std::make_shared<CInstruction>(
-    /*comp=*/kARegister,
-    /*dest=*/kDRegister)
-  );
-  PushBackAll(GetLoadStackPointerToARegisterInstructionSet(), &assembly);
-  assembly.push_back(
-   std::make_shared<CInstruction>(
-    /*comp=*/kDRegister,
-    /*dest=*/kMRegister)
-  );
-  PushBackAll(GetDecrementStackInstructionSet(), &assembly);
-  PushBackAll(GetLoadStackPointerToARegisterInstructionSet(), &assembly);
-  assembly.push_back(
-   std::make_shared<CInstruction>(
-    /*comp=*/kMRegister,
-    /*dest=*/kDRegister)
-  );
-  assembly.push_back(
-   std::make_shared<CInstruction>(
-    /*comp=*/kIncrementARegisterComp,
-    /*dest=*/kARegister)
-  );
-  assembly.push_back(
-   std::make_shared<CInstruction>(
-    /*comp=*/kMRegister,
-    /*dest=*/kARegister)
-  );
+    GetAdjustSegmentBaseInstructionSet(
+      memory_segment_type, memory_segment_address, /*add=*/true), &assembly);
+  PushBackAll(GetPopStackToDRegisterInstructionSet(), &assembly);
+  PushBackAll(
+    GetOffsetChainToARegisterInstructionSet(memory_segment_type, /*offset=*/0),
+    &assembly);
   assembly.push_back(
    std::make_shared<CInstruction>(
     /*comp=*/kDRegister,
     /*dest=*/kMRegister)
   );
+  PushBackAll(
+    GetAdjustSegmentBaseInstructionSet(
+      memory_segment_type, memory_segment_address, /*add=*/false), &assembly);
   return assembly;
 }
 
@@ -387,6 +526,10 @@ AssemblyGenerator::MakeNextLabelInstructionAndIncrementSeed() {
 AssemblyInstructionSet
 AssemblyGenerator::GenerateReturnInstructionSet() const {
   AssemblyInstructionSet assembly;
+  std::string end_frame_address = GetFixedMemorySegmentAddress(
+    VMInstruction::MemorySegmentType::TEMP, kEndFrameTempOffset);
+  std::string return_address = GetFixedMemorySegmentAddress(
+    VMInstruction::MemorySegmentType::TEMP, kReturnAddressTempOffset);
 
   // Store endFrame in TEMP[3]
   assembly.push_back(
@@ -394,14 +537,7 @@ AssemblyGenerator::GenerateReturnInstructionSet() const {
         VMInstruction::MemorySegmentType::LOCAL)));
   assembly.push_back(
     std::make_shared<CInstruction>(/*comp=*/kMRegister, /*dest=*/kDRegister));
-  assembly.push_back(
-    std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(
-        VMInstruction::MemorySegmentType::TEMP)));
-  for (int i = 0; i < 3; i++) {
-    assembly.push_back(
-      std::make_shared<CInstruction>(
-        /*comp=*/kIncrementARegisterComp, /*dest=*/kARegister));
-  }
+  assembly.push_back(std::make_shared<AInstruction>(end_frame_address));
   assembly.push_back(
     std::make_shared<CInstruction>(/*comp=*/kDRegister, /*dest=*/kMRegister));
 
@@ -412,14 +548,7 @@ AssemblyGenerator::GenerateReturnInstructionSet() const {
     /*comp=*/kDMinusAComp, /*dest=*/kARegister));
   assembly.push_back(std::make_shared<CInstruction>(
     /*comp=*/kMRegister, /*dest=*/kDRegister));
-  assembly.push_back(
-    std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(
-        VMInstruction::MemorySegmentType::TEMP)));
-  for (int i = 0; i < 4; i++) {
-    assembly.push_back(
-      std::make_shared<CInstruction>(
-        /*comp=*/kIncrementARegisterComp, /*dest=*/kARegister));
-  }
+  assembly.push_back(std::make_shared<AInstruction>(return_address));
   assembly.push_back(
     std::make_shared<CInstruction>(
       /*comp=*/kDRegister, /*dest=*/kMRegister));
@@ -439,15 +568,13 @@ AssemblyGenerator::GenerateReturnInstructionSet() const {
   assembly.push_back(std::make_shared<CInstruction>(
     /*comp=*/kIncrementDRegisterComp, /*dest=*/kMRegister));
 
-  // Restore values of THAT, THIS, ARGUMENT, and LOCAL
-  auto transfer_from_temp = [this, &assembly](size_t offset, VMInstruction::MemorySegmentType to) {
-    PushBackAll(GetLoadMemorySegmentAddressToARegisterInstructionSet(
-        VMInstruction::MemorySegmentType::TEMP, 3), &assembly);
-    assembly.push_back(std::make_shared<CInstruction>(/*comp=*/kMRegister,
-                                                      /*dest=*/kDRegister));
-    assembly.push_back(std::make_shared<AInstruction>(std::to_string(offset)));
+  // Restore values of THAT, THIS, ARGUMENT, and LOCAL, walking endFrame
+  // down one slot at a time.
+  auto transfer_from_frame = [&assembly, &end_frame_address](
+    VMInstruction::MemorySegmentType to) {
+    assembly.push_back(std::make_shared<AInstruction>(end_frame_address));
     assembly.push_back(std::make_shared<CInstruction>(
-      /*comp=*/kDMinusAComp, /*dest=*/kARegister));
+      /*comp=*/kDecrementMRegisterComp, /*dest=*/kAMRegisters));
     assembly.push_back(std::make_shared<CInstruction>(
       /*comp=*/kMRegister, /*dest=*/kDRegister));
     assembly.push_back(std::make_shared<AInstruction>(
@@ -456,14 +583,13 @@ AssemblyGenerator::GenerateReturnInstructionSet() const {
       /*comp=*/kDRegister, /*dest=*/kMRegister));
   };
 
-  transfer_from_temp(1, VMInstruction::MemorySegmentType::THAT);
-  transfer_from_temp(2, VMInstruction::MemorySegmentType::THIS);
-  transfer_from_temp(3, VMInstruction::MemorySegmentType::ARGUMENT);
-  transfer_from_temp(4, VMInstruction::MemorySegmentType::LOCAL);
+  transfer_from_frame(VMInstruction::MemorySegmentType::THAT);
+  transfer_from_frame(VMInstruction::MemorySegmentType::THIS);
+  transfer_from_frame(VMInstruction::MemorySegmentType::ARGUMENT);
+  transfer_from_frame(VMInstruction::MemorySegmentType::LOCAL);
 
   // goto return address
-  PushBackAll(GetLoadMemorySegmentAddressToARegisterInstructionSet(
-      VMInstruction::MemorySegmentType::TEMP, 4), &assembly);
+  assembly.push_back(std::make_shared<AInstruction>(return_address));
   assembly.push_back(std::make_shared<CInstruction>(
     /*comp=*/kMRegister, /*dest=*/kARegister));
   assembly.push_back(std::make_shared<CInstruction>(
@@ -554,6 +680,82 @@ AssemblyGenerator::GenerateCallInstructionSet(
   return assembly;
 }
 
+AssemblyInstructionSet
+AssemblyGenerator::GenerateTailCallInstructionSet(
+  const std::string& function_name, size_t n_args) const {
+  AssemblyInstructionSet assembly;
+
+  // Our caller's saved frame (LCL-5 .. LCL-1) may be overwritten once the
+  // new arguments are moved down, so first copy it on top of the arguments.
+  // The stack then ends with the n_args + 5 words the callee's frame needs.
+  for (size_t i = kCallFrameSize; i > 0; i--) {
+    assembly.push_back(
+      std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(
+          VMInstruction::MemorySegmentType::LOCAL)));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kMRegister, /*dest=*/kDRegister));
+    assembly.push_back(std::make_shared<AInstruction>(std::to_string(i)));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kDMinusAComp, /*dest=*/kARegister));
+    PushBackAll(GetPushMRegisterToStackInstructionSet(), &assembly);
+  }
+
+  // source = SP - n_args - 5, dest = ARG
+  PushBackAll(GetLoadStackPointerToARegisterInstructionSet(), &assembly);
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kARegister, /*dest=*/kDRegister));
+  assembly.push_back(
+    std::make_shared<AInstruction>(std::to_string(n_args + kCallFrameSize)));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kDMinusAComp, /*dest=*/kDRegister));
+  assembly.push_back(std::make_shared<AInstruction>(kTailCallSourceRegister));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kDRegister, /*dest=*/kMRegister));
+  assembly.push_back(
+    std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(
+        VMInstruction::MemorySegmentType::ARGUMENT)));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kMRegister, /*dest=*/kDRegister));
+  assembly.push_back(std::make_shared<AInstruction>(kTailCallDestRegister));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kDRegister, /*dest=*/kMRegister));
+
+  // Move the block down to ARG. The destination never lies above the
+  // source, so copying upwards is safe even when the two overlap.
+  for (size_t i = 0; i < n_args + kCallFrameSize; i++) {
+    assembly.push_back(std::make_shared<AInstruction>(kTailCallSourceRegister));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kIncrementMRegisterComp, /*dest=*/kMRegister));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kDecrementMRegisterComp, /*dest=*/kARegister));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kMRegister, /*dest=*/kDRegister));
+    assembly.push_back(std::make_shared<AInstruction>(kTailCallDestRegister));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kIncrementMRegisterComp, /*dest=*/kMRegister));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kDecrementMRegisterComp, /*dest=*/kARegister));
+    assembly.push_back(std::make_shared<CInstruction>(
+      /*comp=*/kDRegister, /*dest=*/kMRegister));
+  }
+
+  // LCL = SP = ARG + n_args + 5; ARG stays where it is.
+  assembly.push_back(std::make_shared<AInstruction>(kTailCallDestRegister));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kMRegister, /*dest=*/kDRegister));
+  assembly.push_back(
+    std::make_shared<AInstruction>(kMemorySegmentTypesToRAMAddrs.at(
+        VMInstruction::MemorySegmentType::LOCAL)));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kDRegister, /*dest=*/kMRegister));
+  assembly.push_back(std::make_shared<AInstruction>(kStackPointerRAMLocation));
+  assembly.push_back(std::make_shared<CInstruction>(
+    /*comp=*/kDRegister, /*dest=*/kMRegister));
+
+  PushBackAll(GenerateGotoInstructionSet(function_name), &assembly);
+  return assembly;
+}
+
 AssemblyInstructionSet
 AssemblyGenerator::GenerateArithmeticInstructionSet(
   VMInstruction::VMInstructionType instruction_type) {
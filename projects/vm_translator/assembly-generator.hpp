@@ -5,6 +5,7 @@
 #include "./assembly_instructions/label-instruction.hpp"
 #include "./vm_instructions/vm-instruction.hpp"
 
+#include <boost/optional.hpp>
 #include <memory>
 #include <vector>
 
@@ -27,7 +28,10 @@ typedef std::vector<std::shared_ptr<BaseAssemblyInstruction> > AssemblyInstructi
 //     = generator.GetCurrentInstructionSet();   // Contains ADD, SUBTRACT
 class AssemblyGenerator {
  public:
-  AssemblyGenerator() {}
+  // When |optimize_tail_calls| is set, a `call` immediately followed by
+  // `return` reuses the current frame instead of pushing a new one.
+  explicit AssemblyGenerator(bool optimize_tail_calls = false)
+    : next_label_seed_(0), optimize_tail_calls_(optimize_tail_calls) {}
 
   // Returns a copy of the current set of assembly
   // instructions stored by the class.
@@ -43,6 +47,11 @@ class AssemblyGenerator {
 
   void GenerateInitAssembly();
 
+  // Translates any instruction whose translation was deferred while waiting
+  // on the instruction that follows it. Must be called after the last
+  // GenerateAssemblyFor() call.
+  void FlushPendingInstructions();
+
  private:
   AssemblyInstructionSet
   GenerateArithmeticInstructionSet(
@@ -52,6 +61,10 @@ class AssemblyGenerator {
   GenerateCallInstructionSet(
     const std::string& function_name, size_t n_args);
 
+  AssemblyInstructionSet
+  GenerateTailCallInstructionSet(
+    const std::string& function_name, size_t n_args) const;
+
   std::shared_ptr<LabelInstruction>
   MakeNextLabelInstructionAndIncrementSeed();
 
@@ -65,6 +78,10 @@ class AssemblyGenerator {
   std::string
   MakeStaticSymbol(size_t seed) const;
 
+  // VM labels are scoped to the function that declares them.
+  std::string
+  MakeScopedLabel(const std::string& label) const;
+
   AssemblyInstructionSet
   GenerateLabelInstructionSet(const std::string& label) const;
 
@@ -92,6 +109,10 @@ class AssemblyGenerator {
   AssemblyInstructionSet instructions_;
   size_t next_label_seed_;
   std::string module_name_;
+  std::string current_function_name_;
+  bool optimize_tail_calls_;
+  // A CALL held back until we know whether a RETURN follows it.
+  boost::optional<VMInstruction> pending_call_;
 };
 
 #endif
@@ -0,0 +1,61 @@
+#include "./assembly-peephole-optimizer.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+  const std::vector<std::string> kPushThenPopToD {
+    "@0", "A=M", "M=D", "@0", "M=M+1", "@0", "AM=M-1", "D=M"
+  };
+
+  const std::vector<std::string> kPushThenLoadTopToD {
+    "@0", "A=M", "M=D", "@0", "M=M+1", "@0", "M=M-1", "@0", "A=M", "D=M"
+  };
+
+  // Number of leading instructions of each pattern that are kept: @SP, A=M.
+  constexpr size_t kKeptPrefixLength = 2;
+
+  bool MatchesAt(const std::vector<std::string>& assembly,
+                 size_t index,
+                 const std::vector<std::string>& pattern) {
+    if (index + pattern.size() > assembly.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < pattern.size(); i++) {
+      if (assembly[index + i] != pattern[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+AssemblyInstructionSet EliminatePushPopPairs(const AssemblyInstructionSet& instructions) {
+  std::vector<std::string> assembly;
+  assembly.reserve(instructions.size());
+  for (const auto& instruction : instructions) {
+    assembly.push_back(instruction->ToString());
+  }
+
+  AssemblyInstructionSet optimized;
+  optimized.reserve(instructions.size());
+  size_t i = 0;
+  while (i < instructions.size()) {
+    size_t matched = 0;
+    if (MatchesAt(assembly, i, kPushThenPopToD)) {
+      matched = kPushThenPopToD.size();
+    } else if (MatchesAt(assembly, i, kPushThenLoadTopToD)) {
+      matched = kPushThenLoadTopToD.size();
+    }
+
+    if (matched == 0) {
+      optimized.push_back(instructions[i++]);
+      continue;
+    }
+    for (size_t j = 0; j < kKeptPrefixLength; j++) {
+      optimized.push_back(instructions[i + j]);
+    }
+    i += matched;
+  }
+  return optimized;
+}
@@ -0,0 +1,19 @@
+#ifndef VM_TRANSLATOR_ASSEMBLY_PEEPHOLE_OPTIMIZER_HPP_
+#define VM_TRANSLATOR_ASSEMBLY_PEEPHOLE_OPTIMIZER_HPP_
+
+#include "./assembly-generator.hpp"
+
+// Removes stack traffic between a push and the pop or arithmetic operation
+// that immediately consumes it. A push leaves its value in D before storing
+// it at *SP, so when the very next thing the program does is move SP back
+// down and reload that value, the store and both SP updates can go:
+//
+//   @SP, A=M, M=D, @SP, M=M+1, @SP, AM=M-1, D=M          =>  @SP, A=M
+//   @SP, A=M, M=D, @SP, M=M+1, @SP, M=M-1, @SP, A=M, D=M  =>  @SP, A=M
+//
+// Both rewrites leave A pointing at *SP and D holding the value, which is
+// what the consuming code expects. The skipped store was to a slot above
+// the stack pointer, which nothing reads.
+AssemblyInstructionSet EliminatePushPopPairs(const AssemblyInstructionSet& instructions);
+
+#endif
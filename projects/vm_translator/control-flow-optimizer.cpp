@@ -0,0 +1,196 @@
+#include "./control-flow-optimizer.hpp"
+#include "./util.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace {
+  bool IsLabel(const VMInstruction& instruction) {
+    return instruction.GetInstructionType() == VMInstruction::VMInstructionType::LABEL;
+  }
+
+  bool IsGoto(const VMInstruction& instruction) {
+    return instruction.GetInstructionType() == VMInstruction::VMInstructionType::GOTO;
+  }
+
+  bool IsIfGoto(const VMInstruction& instruction) {
+    return instruction.GetInstructionType() == VMInstruction::VMInstructionType::IFGOTO;
+  }
+
+  bool IsJump(const VMInstruction& instruction) {
+    return IsGoto(instruction) || IsIfGoto(instruction);
+  }
+
+  // Comparisons always leave exactly -1 or 0 on the stack.
+  bool IsComparison(const VMInstruction& instruction) {
+    VMInstruction::VMInstructionType type = instruction.GetInstructionType();
+    return type == VMInstruction::VMInstructionType::EQ ||
+           type == VMInstruction::VMInstructionType::GT ||
+           type == VMInstruction::VMInstructionType::LT;
+  }
+
+  bool EndsBlock(const VMInstruction& instruction) {
+    return IsGoto(instruction) ||
+           instruction.GetInstructionType() == VMInstruction::VMInstructionType::RETURN;
+  }
+
+  // Returns true if the run of labels starting at |index| contains |label|.
+  bool IsLabelAt(const VMInstructionSet& body, size_t index, const std::string& label) {
+    for (size_t i = index; i < body.size() && IsLabel(body[i]); i++) {
+      if (*body[i].GetLabel() == label) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::map<std::string, size_t> GetLabelIndices(const VMInstructionSet& body) {
+    std::map<std::string, size_t> label_indices;
+    for (size_t i = 0; i < body.size(); i++) {
+      if (IsLabel(body[i])) {
+        label_indices[*body[i].GetLabel()] = i;
+      }
+    }
+    return label_indices;
+  }
+
+  // Follows |label| through any chain of `label X; goto Y` blocks and
+  // returns the label control finally lands on. Chains that loop back on
+  // themselves are left alone.
+  std::string ResolveJumpTarget(const VMInstructionSet& body,
+                                const std::map<std::string, size_t>& label_indices,
+                                const std::string& label) {
+    std::set<std::string> visited;
+    std::string target = label;
+    while (label_indices.find(target) != label_indices.end()) {
+      visited.insert(target);
+      size_t i = label_indices.at(target);
+      while (i < body.size() && IsLabel(body[i])) {
+        i++;
+      }
+      if (i == body.size() || !IsGoto(body[i])) {
+        break;
+      }
+      if (visited.find(*body[i].GetLabel()) != visited.end()) {
+        return label;
+      }
+      target = *body[i].GetLabel();
+    }
+    return target;
+  }
+
+  bool ThreadJumps(VMInstructionSet* body) {
+    bool changed = false;
+    std::map<std::string, size_t> label_indices = GetLabelIndices(*body);
+    for (auto& instruction : *body) {
+      if (!IsJump(instruction)) {
+        continue;
+      }
+      std::string target =
+        ResolveJumpTarget(*body, label_indices, *instruction.GetLabel());
+      if (target != *instruction.GetLabel()) {
+        instruction = VMInstruction(instruction.GetInstructionType(), target);
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  bool RemoveFallThroughGotos(VMInstructionSet* body) {
+    bool changed = false;
+    for (size_t i = 0; i < body->size(); i++) {
+      if (IsGoto((*body)[i]) && IsLabelAt(*body, i + 1, *(*body)[i].GetLabel())) {
+        body->erase(body->begin() + i);
+        i--;
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  bool InvertBranches(VMInstructionSet* body) {
+    bool changed = false;
+    for (size_t i = 1; i + 2 < body->size(); i++) {
+      const VMInstruction& if_goto = (*body)[i];
+      const VMInstruction& jump = (*body)[i + 1];
+      if (!IsIfGoto(if_goto) || !IsGoto(jump) ||
+          !IsLabelAt(*body, i + 2, *if_goto.GetLabel())) {
+        continue;
+      }
+
+      // <cmp>; not; if-goto L1; goto L2; label L1  =>  <cmp>; if-goto L2
+      // Inverting any other condition would cost an extra `not`, which is
+      // more expensive than the goto it saves.
+      const VMInstruction& condition = (*body)[i - 1];
+      if (condition.GetInstructionType() == VMInstruction::VMInstructionType::NOT &&
+          i >= 2 && IsComparison((*body)[i - 2])) {
+        VMInstruction inverted(VMInstruction::VMInstructionType::IFGOTO,
+                               *jump.GetLabel());
+        body->erase(body->begin() + i - 1, body->begin() + i + 2);
+        body->insert(body->begin() + i - 1, inverted);
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  bool RemoveUnreachableInstructions(VMInstructionSet* body) {
+    bool changed = false;
+    for (size_t i = 0; i < body->size(); i++) {
+      if (!EndsBlock((*body)[i])) {
+        continue;
+      }
+      size_t end = i + 1;
+      while (end < body->size() && !IsLabel((*body)[end])) {
+        end++;
+      }
+      if (end > i + 1) {
+        body->erase(body->begin() + i + 1, body->begin() + end);
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  bool RemoveUnreferencedLabels(VMInstructionSet* body) {
+    std::set<std::string> referenced;
+    for (const auto& instruction : *body) {
+      if (IsJump(instruction)) {
+        referenced.insert(*instruction.GetLabel());
+      }
+    }
+
+    bool changed = false;
+    for (size_t i = 0; i < body->size(); i++) {
+      if (IsLabel((*body)[i]) &&
+          referenced.find(*(*body)[i].GetLabel()) == referenced.end()) {
+        body->erase(body->begin() + i);
+        i--;
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  void OptimizeFunction(VMInstructionSet* body) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      changed |= ThreadJumps(body);
+      changed |= InvertBranches(body);
+      changed |= RemoveFallThroughGotos(body);
+      changed |= RemoveUnreachableInstructions(body);
+      changed |= RemoveUnreferencedLabels(body);
+    }
+  }
+}
+
+VMInstructionSet OptimizeControlFlow(const VMInstructionSet& instructions) {
+  VMInstructionSet optimized;
+  for (auto& body : SplitIntoFunctions(instructions)) {
+    OptimizeFunction(&body);
+    optimized.insert(optimized.end(), body.begin(), body.end());
+  }
+  return optimized;
+}
@@ -0,0 +1,23 @@
+#ifndef VM_TRANSLATOR_CONTROL_FLOW_OPTIMIZER_HPP_
+#define VM_TRANSLATOR_CONTROL_FLOW_OPTIMIZER_HPP_
+
+#include "./vm_instructions/vm-instruction.hpp"
+
+// Cleans up the control flow of a sequence of VMInstructions. Labels are
+// scoped to the enclosing function, so each function is optimized on its
+// own. Within a function, the following rewrites are applied until none of
+// them makes progress:
+//
+//   - Jump threading: a `goto`/`if-goto` whose target label is followed by
+//     another `goto` is redirected to that goto's target.
+//   - Fall-through elimination: a `goto L` that is followed only by labels
+//     up to and including `label L` is removed.
+//   - Branch inversion: `<cmp>; not; if-goto L1; goto L2; label L1` becomes
+//     `<cmp>; if-goto L2; label L1`. This is only done when <cmp> is a
+//     comparison, since only then is the condition known to be exactly
+//     true (-1) or false (0).
+//   - Unreachable code after `goto`/`return` up to the next label is removed.
+//   - Labels that are no longer referenced are removed.
+VMInstructionSet OptimizeControlFlow(const VMInstructionSet& instructions);
+
+#endif
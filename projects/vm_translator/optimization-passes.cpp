@@ -0,0 +1,98 @@
+#include "./optimization-passes.hpp"
+
+#include "./assembly-peephole-optimizer.hpp"
+#include "./control-flow-optimizer.hpp"
+#include "./register-promotion.hpp"
+#include "./util.hpp"
+
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace {
+  // Number of addressable slots in each bounded segment.
+  const std::map<VMInstruction::MemorySegmentType, size_t> kSegmentSizes {
+    { VMInstruction::MemorySegmentType::POINTER, 2 },
+    { VMInstruction::MemorySegmentType::TEMP, 8 },
+    { VMInstruction::MemorySegmentType::REGISTER, 3 }
+  };
+
+  void VerifyMemoryAccess(const VMInstruction& instruction) {
+    if (!instruction.GetMemorySegmentType() || !instruction.GetMemorySegmentAddress()) {
+      throw std::runtime_error("Memory access without a segment");
+    }
+    VMInstruction::MemorySegmentType segment = *instruction.GetMemorySegmentType();
+    if (segment == VMInstruction::MemorySegmentType::CONSTANT &&
+        instruction.GetInstructionType() == VMInstruction::VMInstructionType::POP) {
+      throw std::runtime_error("Cannot pop to the constant segment");
+    }
+    if (kSegmentSizes.find(segment) != kSegmentSizes.end() &&
+        *instruction.GetMemorySegmentAddress() >= kSegmentSizes.at(segment)) {
+      throw std::runtime_error(
+        "Segment offset out of range: " +
+        std::to_string(*instruction.GetMemorySegmentAddress()));
+    }
+  }
+
+  void VerifyFunction(const VMInstructionSet& body) {
+    std::set<std::string> labels;
+    for (const auto& instruction : body) {
+      if (instruction.GetInstructionType() == VMInstruction::VMInstructionType::LABEL &&
+          !labels.insert(*instruction.GetLabel()).second) {
+        throw std::runtime_error("Label defined twice: " + *instruction.GetLabel());
+      }
+    }
+
+    for (const auto& instruction : body) {
+      switch (instruction.GetInstructionType()) {
+        case VMInstruction::VMInstructionType::GOTO:
+        case VMInstruction::VMInstructionType::IFGOTO:
+          if (labels.find(*instruction.GetLabel()) == labels.end()) {
+            throw std::runtime_error("Jump to undefined label: " + *instruction.GetLabel());
+          }
+          break;
+        case VMInstruction::VMInstructionType::PUSH:
+        case VMInstruction::VMInstructionType::POP:
+          VerifyMemoryAccess(instruction);
+          break;
+        case VMInstruction::VMInstructionType::CALL:
+        case VMInstruction::VMInstructionType::FUNCTION:
+          if (!instruction.GetFunctionName() || instruction.GetFunctionName()->empty()) {
+            throw std::runtime_error("Function instruction without a name");
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+void VerifyVMInstructions(const VMInstructionSet& instructions) {
+  for (const auto& body : SplitIntoFunctions(instructions)) {
+    VerifyFunction(body);
+  }
+}
+
+void VerifyAssemblyInstructions(const AssemblyInstructionSet& instructions) {
+  std::set<std::string> labels;
+  for (const auto& instruction : instructions) {
+    std::string assembly = instruction->ToString();
+    if (!assembly.empty() && assembly.front() == '(' && !labels.insert(assembly).second) {
+      throw std::runtime_error("Label defined twice: " + assembly);
+    }
+  }
+}
+
+void RegisterVMPasses(VMPassManager* pass_manager) {
+  pass_manager->RegisterPass("control-flow", /*min_optimization_level=*/1,
+                             OptimizeControlFlow);
+  pass_manager->RegisterPass("register-promotion", /*min_optimization_level=*/2,
+                             PromoteLeafLocalsToRegisters);
+}
+
+void RegisterAssemblyPasses(AssemblyPassManager* pass_manager) {
+  pass_manager->RegisterPass("push-pop-elimination", /*min_optimization_level=*/1,
+                             EliminatePushPopPairs);
+}
@@ -0,0 +1,30 @@
+#ifndef VM_TRANSLATOR_OPTIMIZATION_PASSES_HPP_
+#define VM_TRANSLATOR_OPTIMIZATION_PASSES_HPP_
+
+#include "./assembly-generator.hpp"
+#include "./pass-manager.hpp"
+#include "./vm_instructions/vm-instruction.hpp"
+
+typedef PassManager<VMInstructionSet> VMPassManager;
+typedef PassManager<AssemblyInstructionSet> AssemblyPassManager;
+
+// Optimization level at which AssemblyGenerator turns tail calls into
+// jumps. Tail calls are generated rather than run as a pass, since they
+// change how `call` and `return` are lowered.
+constexpr int kTailCallOptimizationLevel = 3;
+
+// Throws std::runtime_error if |instructions| is not a well-formed VM
+// program: jumps must target labels of the same function, labels must be
+// unique within a function, and segment accesses must be in range.
+void VerifyVMInstructions(const VMInstructionSet& instructions);
+
+// Throws std::runtime_error if |instructions| defines a label twice.
+void VerifyAssemblyInstructions(const AssemblyInstructionSet& instructions);
+
+// Registers every VM-level pass with its name and minimum -O level.
+void RegisterVMPasses(VMPassManager* pass_manager);
+
+// Registers every assembly-level pass with its name and minimum -O level.
+void RegisterAssemblyPasses(AssemblyPassManager* pass_manager);
+
+#endif
@@ -2,7 +2,6 @@
 #include "./vm_instructions/vm-instruction.hpp"
 
 #include <cstdlib>
-#include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
@@ -10,6 +9,7 @@
 namespace {
   constexpr char kStartOfComment = '/';
   constexpr char kSpaceChar = ' ';
+  constexpr char kTabChar = '\t';
   constexpr char kNewlineChar = '\n';
   constexpr char kCarriageReturnChar = '\r';
 
@@ -55,24 +55,28 @@ namespace {
 }
 
 boost::optional<VMInstruction> ParseLine(const std::string& line) {
-  std::cout << "Parsing: " << line << std::endl;
-  if (line.empty() ||
-      line.front() == kStartOfComment ||
-      line.front() == kNewlineChar ||
-      line.front() == kCarriageReturnChar) {
-    return boost::none;
-  }
-
-  auto advance_next_word = [](std::string::const_iterator& it) -> std::string {
+  // Lines may end without a newline, as std::getline leaves them.
+  auto advance_next_word = [&line](std::string::const_iterator& it) -> std::string {
     std::stringstream ss;
-    while (*it != kSpaceChar && *it != kNewlineChar && *it != kCarriageReturnChar) {
+    while (it != line.end() && *it != kSpaceChar && *it != kTabChar &&
+           *it != kNewlineChar && *it != kCarriageReturnChar) {
       ss << *it;
       it++;
     }
     return ss.str();
   };
+  auto skip_spaces = [&line](std::string::const_iterator& it) {
+    while (it != line.end() && (*it == kSpaceChar || *it == kTabChar)) {
+      it++;
+    }
+  };
 
   auto it = line.begin();
+  skip_spaces(it);
+  if (it == line.end() || *it == kStartOfComment ||
+      *it == kNewlineChar || *it == kCarriageReturnChar) {
+    return boost::none;
+  }
   std::string command = advance_next_word(it);
 
   if (kStringsToNoArgumentInstructionTypes.find(command)
@@ -80,7 +84,7 @@ boost::optional<VMInstruction> ParseLine(const std::string& line) {
     return VMInstruction(kStringsToNoArgumentInstructionTypes.at(command));
   }
 
-  it++;
+  skip_spaces(it);
   std::string first_arg = advance_next_word(it);
 
   if (kStringsToSingleArgumentInstructionTypes.find(command)
@@ -89,7 +93,7 @@ boost::optional<VMInstruction> ParseLine(const std::string& line) {
                          first_arg);
   }
 
-  it++;
+  skip_spaces(it);
   std::string second_arg = advance_next_word(it);
 
   if (kStringsToMemoryInstructionTypes.find(command)
@@ -0,0 +1,105 @@
+#ifndef VM_TRANSLATOR_PASS_MANAGER_HPP_
+#define VM_TRANSLATOR_PASS_MANAGER_HPP_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Running totals for one registered pass, summed over every Run() call.
+struct PassStatistics {
+  std::string name;
+  size_t runs = 0;
+  size_t instructions_before = 0;
+  size_t instructions_after = 0;
+  std::chrono::microseconds duration = std::chrono::microseconds(0);
+};
+
+// Runs a sequence of named optimization passes over one level of the
+// translation pipeline. |InstructionSet| is the IR of that level
+// (VMInstructionSet or AssemblyInstructionSet); it only needs size().
+//
+// Usage:
+//   PassManager<VMInstructionSet> passes(VerifyVMInstructions);
+//   passes.RegisterPass("control-flow", /*min_optimization_level=*/1,
+//                       OptimizeControlFlow);
+//   VMInstructionSet optimized = passes.Run(instructions, /*level=*/2);
+//
+// Passes run in registration order. After each pass the verifier is run on
+// its output; a verifier signals a malformed program by throwing.
+template <typename InstructionSet>
+class PassManager {
+ public:
+  typedef std::function<InstructionSet(const InstructionSet&)> Pass;
+  typedef std::function<void(const InstructionSet&)> Verifier;
+
+  explicit PassManager(const Verifier& verifier) : verifier_(verifier) {}
+
+  // Registers |pass| under |name|. It runs whenever the requested
+  // optimization level is at least |min_optimization_level|.
+  void RegisterPass(const std::string& name,
+                    int min_optimization_level,
+                    const Pass& pass) {
+    if (statistics_.find(name) != statistics_.end()) {
+      throw std::runtime_error("Pass registered twice: " + name);
+    }
+    passes_.push_back({ name, min_optimization_level, pass });
+    statistics_[name].name = name;
+  }
+
+  // Verifies |instructions|, then runs every pass enabled at
+  // |optimization_level| over them.
+  InstructionSet Run(const InstructionSet& instructions, int optimization_level) {
+    Verify("input", instructions);
+    InstructionSet current = instructions;
+    for (const auto& pass : passes_) {
+      if (optimization_level < pass.min_optimization_level) {
+        continue;
+      }
+      PassStatistics& statistics = statistics_.at(pass.name);
+      statistics.runs++;
+      statistics.instructions_before += current.size();
+
+      auto start = std::chrono::steady_clock::now();
+      current = pass.run(current);
+      statistics.duration += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+      statistics.instructions_after += current.size();
+      Verify(pass.name, current);
+    }
+    return current;
+  }
+
+  // Returns the statistics of every registered pass, in registration order.
+  std::vector<PassStatistics> GetStatistics() const {
+    std::vector<PassStatistics> statistics;
+    for (const auto& pass : passes_) {
+      statistics.push_back(statistics_.at(pass.name));
+    }
+    return statistics;
+  }
+
+ private:
+  struct RegisteredPass {
+    std::string name;
+    int min_optimization_level;
+    Pass run;
+  };
+
+  void Verify(const std::string& stage, const InstructionSet& instructions) const {
+    try {
+      verifier_(instructions);
+    } catch (const std::exception& e) {
+      throw std::runtime_error("Verification failed after " + stage + ": " + e.what());
+    }
+  }
+
+  Verifier verifier_;
+  std::vector<RegisteredPass> passes_;
+  std::map<std::string, PassStatistics> statistics_;
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "./register-promotion.hpp"
+#include "./util.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace {
+  constexpr size_t kMaxPromotedLocals = 3;
+
+  bool IsLocalAccess(const VMInstruction& instruction) {
+    return (instruction.GetInstructionType() == VMInstruction::VMInstructionType::PUSH ||
+            instruction.GetInstructionType() == VMInstruction::VMInstructionType::POP) &&
+           *instruction.GetMemorySegmentType() == VMInstruction::MemorySegmentType::LOCAL;
+  }
+
+  bool IsLeafFunction(const VMInstructionSet& body) {
+    return std::none_of(body.begin(), body.end(), [](const VMInstruction& instruction) {
+      return instruction.GetInstructionType() == VMInstruction::VMInstructionType::CALL;
+    });
+  }
+
+  // Returns the locals that are written by the function's straight-line
+  // prologue before anything reads them, and so need no zeroing.
+  std::set<size_t> GetLocalsAssignedBeforeUse(const VMInstructionSet& body) {
+    std::set<size_t> assigned;
+    std::set<size_t> read;
+    for (size_t i = 1; i < body.size(); i++) {
+      VMInstruction::VMInstructionType type = body[i].GetInstructionType();
+      if (type == VMInstruction::VMInstructionType::LABEL ||
+          type == VMInstruction::VMInstructionType::GOTO ||
+          type == VMInstruction::VMInstructionType::IFGOTO ||
+          type == VMInstruction::VMInstructionType::RETURN) {
+        break;
+      }
+      if (!IsLocalAccess(body[i])) {
+        continue;
+      }
+      size_t local = *body[i].GetMemorySegmentAddress();
+      if (type == VMInstruction::VMInstructionType::PUSH) {
+        read.insert(local);
+      } else if (read.find(local) == read.end()) {
+        assigned.insert(local);
+      }
+    }
+    return assigned;
+  }
+
+  VMInstructionSet PromoteLocals(const VMInstructionSet& body) {
+    const VMInstruction& function = body.front();
+    if (function.GetInstructionType() != VMInstruction::VMInstructionType::FUNCTION ||
+        *function.GetNVars() == 0 || !IsLeafFunction(body)) {
+      return body;
+    }
+    size_t n_vars = *function.GetNVars();
+
+    // Rank locals by how often they are accessed. Code that reaches past its
+    // declared locals depends on the frame layout, so leave it alone.
+    std::vector<size_t> access_counts(n_vars, 0);
+    for (const auto& instruction : body) {
+      if (!IsLocalAccess(instruction)) {
+        continue;
+      }
+      if (*instruction.GetMemorySegmentAddress() >= n_vars) {
+        return body;
+      }
+      access_counts[*instruction.GetMemorySegmentAddress()]++;
+    }
+    std::vector<size_t> locals(n_vars);
+    for (size_t i = 0; i < n_vars; i++) {
+      locals[i] = i;
+    }
+    std::stable_sort(locals.begin(), locals.end(), [&access_counts](size_t a, size_t b) {
+      return access_counts[a] > access_counts[b];
+    });
+
+    // Promoted locals map to a register; the rest are packed into the frame.
+    std::map<size_t, size_t> registers;
+    for (size_t i = 0; i < std::min(n_vars, kMaxPromotedLocals); i++) {
+      registers[locals[i]] = i;
+    }
+    std::map<size_t, size_t> frame_slots;
+    size_t next_frame_slot = 0;
+    for (size_t i = 0; i < n_vars; i++) {
+      if (registers.find(i) == registers.end()) {
+        frame_slots[i] = next_frame_slot++;
+      }
+    }
+
+    VMInstructionSet promoted;
+    promoted.push_back(VMInstruction(VMInstruction::VMInstructionType::FUNCTION,
+                                     *function.GetFunctionName(),
+                                     frame_slots.size()));
+    std::set<size_t> assigned = GetLocalsAssignedBeforeUse(body);
+    for (const auto& local_and_register : registers) {
+      if (assigned.find(local_and_register.first) != assigned.end()) {
+        continue;
+      }
+      promoted.push_back(VMInstruction(VMInstruction::VMInstructionType::PUSH,
+                                       VMInstruction::MemorySegmentType::CONSTANT,
+                                       0));
+      promoted.push_back(VMInstruction(VMInstruction::VMInstructionType::POP,
+                                       VMInstruction::MemorySegmentType::REGISTER,
+                                       local_and_register.second));
+    }
+
+    for (size_t i = 1; i < body.size(); i++) {
+      if (!IsLocalAccess(body[i])) {
+        promoted.push_back(body[i]);
+        continue;
+      }
+      size_t local = *body[i].GetMemorySegmentAddress();
+      if (registers.find(local) != registers.end()) {
+        promoted.push_back(VMInstruction(body[i].GetInstructionType(),
+                                         VMInstruction::MemorySegmentType::REGISTER,
+                                         registers.at(local)));
+      } else {
+        promoted.push_back(VMInstruction(body[i].GetInstructionType(),
+                                         VMInstruction::MemorySegmentType::LOCAL,
+                                         frame_slots.at(local)));
+      }
+    }
+    return promoted;
+  }
+}
+
+VMInstructionSet PromoteLeafLocalsToRegisters(const VMInstructionSet& instructions) {
+  VMInstructionSet promoted;
+  for (const auto& body : SplitIntoFunctions(instructions)) {
+    VMInstructionSet function = PromoteLocals(body);
+    promoted.insert(promoted.end(), function.begin(), function.end());
+  }
+  return promoted;
+}
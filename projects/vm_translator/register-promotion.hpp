@@ -0,0 +1,17 @@
+#ifndef VM_TRANSLATOR_REGISTER_PROMOTION_HPP_
+#define VM_TRANSLATOR_REGISTER_PROMOTION_HPP_
+
+#include "./vm_instructions/vm-instruction.hpp"
+
+// Moves locals of leaf functions (functions that contain no `call`) out of
+// the LCL frame and into the REGISTER segment (R13-R15). Nothing else can
+// run while a leaf function is active, so the registers are free for its
+// whole lifetime.
+//
+// Up to three of the most frequently accessed locals are promoted. The
+// remaining locals are renumbered so the frame shrinks accordingly. A
+// promoted local is explicitly zeroed on entry unless the function's
+// straight-line prologue pops into it before it is ever pushed.
+VMInstructionSet PromoteLeafLocalsToRegisters(const VMInstructionSet& instructions);
+
+#endif
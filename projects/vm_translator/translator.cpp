@@ -1,12 +1,19 @@
 #include "./translator.hpp"
 #include "./parser.hpp"
 #include "./assembly-generator.hpp"
+#include "./optimization-passes.hpp"
 
 #include <boost/filesystem.hpp>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 
 namespace {
+  constexpr char kTailCallsFlag[] = "--tail-calls";
+  constexpr char kPassStatisticsFlag[] = "--pass-stats";
+  constexpr char kOptimizationLevelPrefix[] = "-O";
+  constexpr int kMaxOptimizationLevel = 3;
+
   std::string RemoveVMSuffix(const std::string& filename) {
     return filename.substr(0, filename.size() - 3);
   }
@@ -14,41 +21,78 @@ namespace {
   bool IsVMFile(const std::string& filename) {
     return filename.size() >= 3 && filename.substr(filename.size() - 3) == ".vm";
   }
+
+  void PrintPassStatistics(const std::string& level,
+                           const std::vector<PassStatistics>& statistics) {
+    for (const auto& pass : statistics) {
+      std::cerr << std::left << std::setw(6) << level
+                << std::setw(24) << pass.name
+                << std::right << std::setw(8) << pass.instructions_before << " -> "
+                << std::setw(8) << pass.instructions_after
+                << std::setw(10) << pass.duration.count() << " us"
+                << "\n";
+    }
+  }
 }
 
 void GenerateAssemblyFromFile(const boost::filesystem::path& path,
-                          AssemblyGenerator* generator) {
+                              int optimization_level,
+                              VMPassManager* vm_passes,
+                              AssemblyGenerator* generator) {
   generator->ResetModuleName(RemoveVMSuffix(path.filename().string()));
   std::ifstream ifs;
   ifs.open(path.generic_string(), std::ifstream::in);
   std::cout << "PATH: " << path.generic_string() << std::endl;
 
+  // Labels are function-scoped and functions never span files, so each file
+  // goes through the VM-level passes on its own.
+  VMInstructionSet instructions;
   std::string line;
   while (std::getline(ifs, line)) {
     boost::optional<VMInstruction> instruction = ParseLine(line);
     if (instruction) {
-      generator->GenerateAssemblyFor(*instruction);
+      instructions.push_back(*instruction);
     }
   }
+
+  for (const auto& instruction : vm_passes->Run(instructions, optimization_level)) {
+    generator->GenerateAssemblyFor(instruction);
+  }
 }
 
 void TranslateVMToAssembly(const std::string& path_in,
-                           const std::string& file_out) {
-  AssemblyGenerator generator;
+                           const std::string& file_out,
+                           const TranslatorOptions& options) {
+  VMPassManager vm_passes(VerifyVMInstructions);
+  RegisterVMPasses(&vm_passes);
+  AssemblyPassManager assembly_passes(VerifyAssemblyInstructions);
+  RegisterAssemblyPasses(&assembly_passes);
+
+  AssemblyGenerator generator(
+    options.optimize_tail_calls ||
+    options.optimization_level >= kTailCallOptimizationLevel);
   generator.GenerateInitAssembly();
 
   if (boost::filesystem::is_regular_file(path_in)) {
     boost::filesystem::path path(path_in);
-    GenerateAssemblyFromFile(path, &generator);
+    GenerateAssemblyFromFile(path, options.optimization_level, &vm_passes, &generator);
   } else {
     for (const auto & entry : boost::filesystem::directory_iterator(path_in)) {
       if (IsVMFile(entry.path().filename().string())) {
-        GenerateAssemblyFromFile(entry.path(), &generator);
+        GenerateAssemblyFromFile(
+          entry.path(), options.optimization_level, &vm_passes, &generator);
       }
     }
   }
+  generator.FlushPendingInstructions();
+
+  AssemblyInstructionSet program = assembly_passes.Run(
+    generator.GetCurrentInstructionSet(), options.optimization_level);
 
-  AssemblyInstructionSet program = generator.GetCurrentInstructionSet();
+  if (options.print_pass_statistics) {
+    PrintPassStatistics("vm", vm_passes.GetStatistics());
+    PrintPassStatistics("asm", assembly_passes.GetStatistics());
+  }
 
   std::ofstream ofs;
   ofs.open(file_out, std::ofstream::out);
@@ -63,6 +107,21 @@ int main(int argc, char** argv) {
     std::cerr << "You must supply input and output file names!" << "\n";
     return 1;
   }
-  TranslateVMToAssembly(argv[1], argv[2]);
+  TranslatorOptions options;
+  for (int i = 3; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg == kTailCallsFlag) {
+      options.optimize_tail_calls = true;
+    } else if (arg == kPassStatisticsFlag) {
+      options.print_pass_statistics = true;
+    } else if (arg.size() == 3 && arg.compare(0, 2, kOptimizationLevelPrefix) == 0 &&
+               arg[2] >= '0' && arg[2] - '0' <= kMaxOptimizationLevel) {
+      options.optimization_level = arg[2] - '0';
+    } else {
+      std::cerr << "Unknown option: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  TranslateVMToAssembly(argv[1], argv[2], options);
   return 0;
 }
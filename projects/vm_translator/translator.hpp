@@ -3,6 +3,17 @@
 
 #include <string>
 
-void TranslateVMToAssembly(const std::string& file_in, const std::string& file_out);
+struct TranslatorOptions {
+  // -O level; each optimization pass declares the level that enables it.
+  int optimization_level = 2;
+  // Enables tail calls regardless of |optimization_level|.
+  bool optimize_tail_calls = false;
+  // Prints per-pass instruction counts and run times to stderr.
+  bool print_pass_statistics = false;
+};
+
+void TranslateVMToAssembly(const std::string& file_in,
+                           const std::string& file_out,
+                           const TranslatorOptions& options);
 
 #endif
@@ -10,3 +10,15 @@ void PushBackAll(const AssemblyInstructionSet& source,
     dest->push_back(std::move(instruction));
   });
 }
+
+std::vector<VMInstructionSet> SplitIntoFunctions(const VMInstructionSet& instructions) {
+  std::vector<VMInstructionSet> functions;
+  for (const auto& instruction : instructions) {
+    if (functions.empty() ||
+        instruction.GetInstructionType() == VMInstruction::VMInstructionType::FUNCTION) {
+      functions.emplace_back();
+    }
+    functions.back().push_back(instruction);
+  }
+  return functions;
+}
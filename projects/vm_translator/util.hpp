@@ -3,6 +3,7 @@
 
 #include "./assembly_instructions/base-assembly-instruction.hpp"
 #include "./assembly-generator.hpp"
+#include "./vm_instructions/vm-instruction.hpp"
 
 #include <memory>
 #include <vector>
@@ -10,4 +11,9 @@
 void PushBackAll(const AssemblyInstructionSet& source,
                  AssemblyInstructionSet* dest);
 
+// Splits |instructions| into per-function chunks, each starting at its
+// `function` instruction. Anything before the first `function` forms a
+// chunk of its own.
+std::vector<VMInstructionSet> SplitIntoFunctions(const VMInstructionSet& instructions);
+
 #endif
@@ -3,6 +3,7 @@
 
 #include <boost/optional.hpp>
 #include <string>
+#include <vector>
 
 // Class representing a single VM Instruction.
 class VMInstruction {
@@ -37,7 +38,10 @@ class VMInstruction {
       CONSTANT,
       STATIC,
       POINTER,
-      TEMP
+      TEMP,
+      // Not part of the VM language: the general-purpose registers R13-R15,
+      // which optimization passes may hand out to locals of leaf functions.
+      REGISTER
     };
 
     VMInstruction(VMInstructionType instruction_type)
@@ -100,4 +104,6 @@ class VMInstruction {
     boost::optional<size_t> n_elems_;
 };
 
+typedef std::vector<VMInstruction> VMInstructionSet;
+
 #endif